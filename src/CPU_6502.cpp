@@ -1,28 +1,30 @@
 #include "CPU_6502.h"
+#include "NesPageTableBus.h"
+#include "Config.h"
 
 
+template <typename busType>
+void CPU_6502<busType>::connectBus(std::shared_ptr<IBus<uint16_t, uint8_t>> bus) {
+	m_typedBus = dynamic_cast<busType*>(bus.get());
+	if (m_typedBus == nullptr)
+		throw std::invalid_argument("Bus type doesn't match the one the CPU was built for");
 
-struct CPU_6502::CpuInstruction
-{
-	std::string name;
-	uint8_t(CPU_6502::* operation)(void) = nullptr;
-	uint8_t(CPU_6502::* addressMode)(void) = nullptr;
-	uint8_t cycles = 0;
-};
-
-void CPU_6502::connectBus(std::shared_ptr<IBus<uint16_t, uint8_t>> bus) {
 	m_bus = bus;
+	m_directPages = m_bus->directPages();
 }
 
-bool CPU_6502::isIMP() {
-	return (lookup[opcode].addressMode == &CPU_6502::IMP);
+template <typename busType>
+bool CPU_6502<busType>::isIMP() {
+	return (opcodeTable[opcode].addressMode == ADDRESS_MODE::IMP);
 }
 
-bool CPU_6502::isIMM() {
-	return (lookup[opcode].addressMode == &CPU_6502::IMM);
+template <typename busType>
+bool CPU_6502<busType>::isIMM() {
+	return (opcodeTable[opcode].addressMode == ADDRESS_MODE::IMM);
 }
 
-uint8_t CPU_6502::fetchData() {
+template <typename busType>
+uint8_t CPU_6502<busType>::fetchData() {
 	if (!isIMP())
 		fetchedData = readFrom(addressAbsolute);
 
@@ -30,7 +32,8 @@ uint8_t CPU_6502::fetchData() {
 }
 
 // CPU Reset Function
-void CPU_6502::reset() {
+template <typename busType>
+void CPU_6502<busType>::reset() {
 	size_t totalCyclesPassed = 0;
 
 	// Get address for start of execution
@@ -54,7 +57,8 @@ void CPU_6502::reset() {
 	cycles = 7;
 }
 
-void CPU_6502::reset(uint16_t pc) {
+template <typename busType>
+void CPU_6502<busType>::reset(uint16_t pc) {
 	size_t totalCyclesPassed = 0;
 
 	// Set Program Counter to reset address
@@ -76,7 +80,8 @@ void CPU_6502::reset(uint16_t pc) {
 
 
 // Interrupt Request
-void CPU_6502::irq() {
+template <typename busType>
+void CPU_6502<busType>::irq() {
 	if (PS.ID == 0) {
 		push(highByte(PC));
 		push(lowByte(PC));
@@ -97,7 +102,8 @@ void CPU_6502::irq() {
 }
 
 // Non-Maskable Interrupt
-void CPU_6502::nmi() {
+template <typename busType>
+void CPU_6502<busType>::nmi() {
 	push(highByte(PC));
 	push(lowByte(PC));
 
@@ -114,56 +120,140 @@ void CPU_6502::nmi() {
 	cycles = 8;
 }
 
-// Runs every clock cycle
-void CPU_6502::tick() {
-	if (cycles == 0) {
-		opcode = readFrom(PC++);
-		
-		PS.XX = 1;
+// Fetches, decodes and executes one instruction,
+// leaves its length in cycles in "cycles"
+template <typename busType>
+void CPU_6502<busType>::executeInstruction() {
+	opcode = readFrom(PC++);
+
+	PS.XX = 1;
 
-		currentInstructionName = (this->lookup[opcode].name);
+#ifdef CPU_SWITCH_DISPATCH
+	dispatchInstruction();
+#else
+	cycles = opcodeTable[opcode].cycles;
 
-		cycles = lookup[opcode].cycles;
+	uint8_t additionalCycle1 = (this->*lookup[opcode].addressMode)();
+	uint8_t additionalCycle2 = (this->*lookup[opcode].operation)();
 
-		uint8_t additionalCycle1 = (this->*lookup[opcode].addressMode)();
-		uint8_t additionalCycle2 = (this->*lookup[opcode].operation)();
+	cycles += (additionalCycle1 & additionalCycle2);
+#endif
 
-		cycles += (additionalCycle1 & additionalCycle2);
+	PS.XX = 1;
+}
 
-		PS.XX = 1;
+// Runs every clock cycle, kept for callers that interleave
+// other components with the CPU cycle by cycle
+template <typename busType>
+void CPU_6502<busType>::tick() {
+	if (cycles == 0) {
+		if (m_irqLine && PS.ID == 0)
+			irq();
+		else
+			executeInstruction();
 	}
 
 	totalCyclesPassed++;
 	cycles--;
 }
 
-bool CPU_6502::isFinished() {
+// Runs whole instructions until at least targetCycle cycles have passed,
+// returns by how many cycles the last instruction overshot the target
+template <typename busType>
+size_t CPU_6502<busType>::runUntil(size_t targetCycle) {
+	// Account for what tick() or an interrupt left in flight
+	totalCyclesPassed += cycles;
+	cycles = 0;
+
+	m_targetCycle = targetCycle;
+	while (totalCyclesPassed < m_targetCycle) {
+		if (m_irqLine && PS.ID == 0)
+			irq();
+		else
+			executeInstruction();
+
+		totalCyclesPassed += cycles;
+		cycles = 0;
+	}
+
+	// Runs ended early didn't overshoot
+	return (totalCyclesPassed > targetCycle) ? totalCyclesPassed - targetCycle : 0;
+}
+
+template <typename busType>
+size_t CPU_6502<busType>::runCycles(size_t budget) {
+	return runUntil(totalCyclesPassed + budget);
+}
+
+template <typename busType>
+bool CPU_6502<busType>::isFinished() {
 	return cycles == 0;
 }
 
 //	+-----------------------+
-//	|	  Lookup Vector		|
+//	|	   Save States		|
 //	+-----------------------+
 
-using c = CPU_6502;
-
-std::vector<CPU_6502::CpuInstruction> CPU_6502::lookup =
-{
-//			|               x0            |               x1             |               x2             |               x3             |               x4             |               x5             |               x6             |               x7             |               x8             |               x9             |               xA             |               xB             |               xC             |               xD             |               xE             |               xF             |
-/*  0x  */	{ "BRK", &c::BRK, &c::IMM, 7 },{ "ORA", &c::ORA, &c::IZX, 6 },{ "???", &c::XXX, &c::IMP, 2 },{ "SLO", &c::SLO, &c::IZX, 8 },{ "NOP", &c::NOP, &c::ZP0, 3 },{ "ORA", &c::ORA, &c::ZP0, 3 },{ "ASL", &c::ASL, &c::ZP0, 5 },{ "SLO", &c::SLO, &c::ZP0, 5 },{ "PHP", &c::PHP, &c::IMP, 3 },{ "ORA", &c::ORA, &c::IMM, 2 },{ "ASL", &c::ASL, &c::IMP, 2 },{ "???", &c::XXX, &c::IMP, 2 },{ "NOP", &c::NOP, &c::ABS, 4 },{ "ORA", &c::ORA, &c::ABS, 4 },{ "ASL", &c::ASL, &c::ABS, 6 },{ "SLO", &c::SLO, &c::ABS, 6 },
-/*  1x  */	{ "BPL", &c::BPL, &c::REL, 2 },{ "ORA", &c::ORA, &c::IZY, 5 },{ "???", &c::XXX, &c::IMP, 2 },{ "SLO", &c::SLO, &c::IZY, 8 },{ "NOP", &c::NOP, &c::ZPX, 4 },{ "ORA", &c::ORA, &c::ZPX, 4 },{ "ASL", &c::ASL, &c::ZPX, 6 },{ "SLO", &c::SLO, &c::ZPX, 6 },{ "CLC", &c::CLC, &c::IMP, 2 },{ "ORA", &c::ORA, &c::ABY, 4 },{ "NOP", &c::NOP, &c::IMP, 2 },{ "SLO", &c::SLO, &c::ABY, 7 },{ "NOP", &c::NOP, &c::ABX, 4 },{ "ORA", &c::ORA, &c::ABX, 4 },{ "ASL", &c::ASL, &c::ABX, 7 },{ "SLO", &c::SLO, &c::ABX, 7 },
-/*  2x  */	{ "JSR", &c::JSR, &c::ABS, 6 },{ "AND", &c::AND, &c::IZX, 6 },{ "???", &c::XXX, &c::IMP, 2 },{ "RLA", &c::RLA, &c::IZX, 8 },{ "BIT", &c::BIT, &c::ZP0, 3 },{ "AND", &c::AND, &c::ZP0, 3 },{ "ROL", &c::ROL, &c::ZP0, 5 },{ "RLA", &c::RLA, &c::ZP0, 5 },{ "PLP", &c::PLP, &c::IMP, 4 },{ "AND", &c::AND, &c::IMM, 2 },{ "ROL", &c::ROL, &c::IMP, 2 },{ "???", &c::XXX, &c::IMP, 2 },{ "BIT", &c::BIT, &c::ABS, 4 },{ "AND", &c::AND, &c::ABS, 4 },{ "ROL", &c::ROL, &c::ABS, 6 },{ "RLA", &c::RLA, &c::ABS, 6 },
-/*  3x  */	{ "BMI", &c::BMI, &c::REL, 2 },{ "AND", &c::AND, &c::IZY, 5 },{ "???", &c::XXX, &c::IMP, 2 },{ "RLA", &c::RLA, &c::IZY, 8 },{ "NOP", &c::NOP, &c::ZPX, 4 },{ "AND", &c::AND, &c::ZPX, 4 },{ "ROL", &c::ROL, &c::ZPX, 6 },{ "RLA", &c::RLA, &c::ZPX, 6 },{ "SEC", &c::SEC, &c::IMP, 2 },{ "AND", &c::AND, &c::ABY, 4 },{ "NOP", &c::NOP, &c::IMP, 2 },{ "RLA", &c::RLA, &c::ABY, 7 },{ "NOP", &c::NOP, &c::ABX, 4 },{ "AND", &c::AND, &c::ABX, 4 },{ "ROL", &c::ROL, &c::ABX, 7 },{ "RLA", &c::RLA, &c::ABX, 7 },
-/*  4x  */	{ "RTI", &c::RTI, &c::IMP, 6 },{ "EOR", &c::EOR, &c::IZX, 6 },{ "???", &c::XXX, &c::IMP, 2 },{ "SRE", &c::SRE, &c::IZX, 8 },{ "NOP", &c::NOP, &c::ZP0, 3 },{ "EOR", &c::EOR, &c::ZP0, 3 },{ "LSR", &c::LSR, &c::ZP0, 5 },{ "SRE", &c::SRE, &c::ZP0, 5 },{ "PHA", &c::PHA, &c::IMP, 3 },{ "EOR", &c::EOR, &c::IMM, 2 },{ "LSR", &c::LSR, &c::IMP, 2 },{ "???", &c::XXX, &c::IMP, 2 },{ "JMP", &c::JMP, &c::ABS, 3 },{ "EOR", &c::EOR, &c::ABS, 4 },{ "LSR", &c::LSR, &c::ABS, 6 },{ "SRE", &c::SRE, &c::ABS, 6 },
-/*  5x  */	{ "BVC", &c::BVC, &c::REL, 2 },{ "EOR", &c::EOR, &c::IZY, 5 },{ "???", &c::XXX, &c::IMP, 2 },{ "SRE", &c::SRE, &c::IZY, 8 },{ "NOP", &c::NOP, &c::ZPX, 4 },{ "EOR", &c::EOR, &c::ZPX, 4 },{ "LSR", &c::LSR, &c::ZPX, 6 },{ "SRE", &c::SRE, &c::ZPX, 6 },{ "CLI", &c::CLI, &c::IMP, 2 },{ "EOR", &c::EOR, &c::ABY, 4 },{ "NOP", &c::NOP, &c::IMP, 2 },{ "SRE", &c::SRE, &c::ABY, 7 },{ "NOP", &c::NOP, &c::ABX, 4 },{ "EOR", &c::EOR, &c::ABX, 4 },{ "LSR", &c::LSR, &c::ABX, 7 },{ "SRE", &c::SRE, &c::ABX, 7 },
-/*  6x  */	{ "RTS", &c::RTS, &c::IMP, 6 },{ "ADC", &c::ADC, &c::IZX, 6 },{ "???", &c::XXX, &c::IMP, 2 },{ "RRA", &c::RRA, &c::IZX, 8 },{ "NOP", &c::NOP, &c::ZP0, 3 },{ "ADC", &c::ADC, &c::ZP0, 3 },{ "ROR", &c::ROR, &c::ZP0, 5 },{ "RRA", &c::RRA, &c::ZP0, 5 },{ "PLA", &c::PLA, &c::IMP, 4 },{ "ADC", &c::ADC, &c::IMM, 2 },{ "ROR", &c::ROR, &c::IMP, 2 },{ "???", &c::XXX, &c::IMP, 2 },{ "JMP", &c::JMP, &c::IND, 5 },{ "ADC", &c::ADC, &c::ABS, 4 },{ "ROR", &c::ROR, &c::ABS, 6 },{ "RRA", &c::RRA, &c::ABS, 6 },
-/*  7x  */	{ "BVS", &c::BVS, &c::REL, 2 },{ "ADC", &c::ADC, &c::IZY, 5 },{ "???", &c::XXX, &c::IMP, 2 },{ "RRA", &c::RRA, &c::IZY, 8 },{ "NOP", &c::NOP, &c::ZPX, 4 },{ "ADC", &c::ADC, &c::ZPX, 4 },{ "ROR", &c::ROR, &c::ZPX, 6 },{ "RRA", &c::RRA, &c::ZPX, 6 },{ "SEI", &c::SEI, &c::IMP, 2 },{ "ADC", &c::ADC, &c::ABY, 4 },{ "NOP", &c::NOP, &c::IMP, 2 },{ "RRA", &c::RRA, &c::ABY, 7 },{ "NOP", &c::NOP, &c::ABX, 4 },{ "ADC", &c::ADC, &c::ABX, 4 },{ "ROR", &c::ROR, &c::ABX, 7 },{ "RRA", &c::RRA, &c::ABX, 7 },
-/*  8x  */	{ "NOP", &c::NOP, &c::IMM, 2 },{ "STA", &c::STA, &c::IZX, 6 },{ "???", &c::NOP, &c::IMP, 2 },{ "SAX", &c::SAX, &c::IZX, 6 },{ "STY", &c::STY, &c::ZP0, 3 },{ "STA", &c::STA, &c::ZP0, 3 },{ "STX", &c::STX, &c::ZP0, 3 },{ "SAX", &c::SAX, &c::ZP0, 3 },{ "DEY", &c::DEY, &c::IMP, 2 },{ "???", &c::NOP, &c::IMP, 2 },{ "TXA", &c::TXA, &c::IMP, 2 },{ "???", &c::XXX, &c::IMP, 2 },{ "STY", &c::STY, &c::ABS, 4 },{ "STA", &c::STA, &c::ABS, 4 },{ "STX", &c::STX, &c::ABS, 4 },{ "SAX", &c::SAX, &c::ABS, 4 },
-/*  9x  */	{ "BCC", &c::BCC, &c::REL, 2 },{ "STA", &c::STA, &c::IZY, 6 },{ "???", &c::XXX, &c::IMP, 2 },{ "???", &c::XXX, &c::IMP, 6 },{ "STY", &c::STY, &c::ZPX, 4 },{ "STA", &c::STA, &c::ZPX, 4 },{ "STX", &c::STX, &c::ZPY, 4 },{ "SAX", &c::SAX, &c::ZPY, 4 },{ "TYA", &c::TYA, &c::IMP, 2 },{ "STA", &c::STA, &c::ABY, 5 },{ "TXS", &c::TXS, &c::IMP, 2 },{ "???", &c::XXX, &c::IMP, 5 },{ "NOP", &c::NOP, &c::ABX, 5 },{ "STA", &c::STA, &c::ABX, 5 },{ "???", &c::XXX, &c::IMP, 5 },{ "???", &c::XXX, &c::IMP, 5 },
-/*  Ax  */	{ "LDY", &c::LDY, &c::IMM, 2 },{ "LDA", &c::LDA, &c::IZX, 6 },{ "LDX", &c::LDX, &c::IMM, 2 },{ "LAX", &c::LAX, &c::IZX, 6 },{ "LDY", &c::LDY, &c::ZP0, 3 },{ "LDA", &c::LDA, &c::ZP0, 3 },{ "LDX", &c::LDX, &c::ZP0, 3 },{ "LAX", &c::LAX, &c::ZP0, 3 },{ "TAY", &c::TAY, &c::IMP, 2 },{ "LDA", &c::LDA, &c::IMM, 2 },{ "TAX", &c::TAX, &c::IMP, 2 },{ "???", &c::XXX, &c::IMP, 2 },{ "LDY", &c::LDY, &c::ABS, 4 },{ "LDA", &c::LDA, &c::ABS, 4 },{ "LDX", &c::LDX, &c::ABS, 4 },{ "LAX", &c::LAX, &c::ABS, 4 },
-/*  Bx  */	{ "BCS", &c::BCS, &c::REL, 2 },{ "LDA", &c::LDA, &c::IZY, 5 },{ "???", &c::XXX, &c::IMP, 2 },{ "LAX", &c::LAX, &c::IZY, 5 },{ "LDY", &c::LDY, &c::ZPX, 4 },{ "LDA", &c::LDA, &c::ZPX, 4 },{ "LDX", &c::LDX, &c::ZPY, 4 },{ "LAX", &c::LAX, &c::ZPY, 4 },{ "CLV", &c::CLV, &c::IMP, 2 },{ "LDA", &c::LDA, &c::ABY, 4 },{ "TSX", &c::TSX, &c::IMP, 2 },{ "???", &c::XXX, &c::IMP, 4 },{ "LDY", &c::LDY, &c::ABX, 4 },{ "LDA", &c::LDA, &c::ABX, 4 },{ "LDX", &c::LDX, &c::ABY, 4 },{ "LAX", &c::LAX, &c::ABY, 4 },
-/*  Cx  */	{ "CPY", &c::CPY, &c::IMM, 2 },{ "CMP", &c::CMP, &c::IZX, 6 },{ "???", &c::NOP, &c::IMP, 2 },{ "DCP", &c::DCP, &c::IZX, 8 },{ "CPY", &c::CPY, &c::ZP0, 3 },{ "CMP", &c::CMP, &c::ZP0, 3 },{ "DEC", &c::DEC, &c::ZP0, 5 },{ "DCP", &c::DCP, &c::ZP0, 5 },{ "INY", &c::INY, &c::IMP, 2 },{ "CMP", &c::CMP, &c::IMM, 2 },{ "DEX", &c::DEX, &c::IMP, 2 },{ "???", &c::XXX, &c::IMP, 2 },{ "CPY", &c::CPY, &c::ABS, 4 },{ "CMP", &c::CMP, &c::ABS, 4 },{ "DEC", &c::DEC, &c::ABS, 6 },{ "DCP", &c::DCP, &c::ABS, 6 },
-/*  Dx  */	{ "BNE", &c::BNE, &c::REL, 2 },{ "CMP", &c::CMP, &c::IZY, 5 },{ "???", &c::XXX, &c::IMP, 2 },{ "DCP", &c::DCP, &c::IZY, 8 },{ "NOP", &c::NOP, &c::ZPX, 4 },{ "CMP", &c::CMP, &c::ZPX, 4 },{ "DEC", &c::DEC, &c::ZPX, 6 },{ "DCP", &c::DCP, &c::ZPX, 6 },{ "CLD", &c::CLD, &c::IMP, 2 },{ "CMP", &c::CMP, &c::ABY, 4 },{ "NOP", &c::NOP, &c::IMP, 2 },{ "DCP", &c::DCP, &c::ABY, 7 },{ "NOP", &c::NOP, &c::ABX, 4 },{ "CMP", &c::CMP, &c::ABX, 4 },{ "DEC", &c::DEC, &c::ABX, 7 },{ "DCP", &c::DCP, &c::ABX, 7 },
-/*  Ex  */	{ "CPX", &c::CPX, &c::IMM, 2 },{ "SBC", &c::SBC, &c::IZX, 6 },{ "???", &c::NOP, &c::IMP, 2 },{ "ISB", &c::ISB, &c::IZX, 8 },{ "CPX", &c::CPX, &c::ZP0, 3 },{ "SBC", &c::SBC, &c::ZP0, 3 },{ "INC", &c::INC, &c::ZP0, 5 },{ "ISB", &c::ISB, &c::ZP0, 5 },{ "INX", &c::INX, &c::IMP, 2 },{ "SBC", &c::SBC, &c::IMM, 2 },{ "NOP", &c::NOP, &c::IMP, 2 },{ "SBC", &c::SBC, &c::IMM, 2 },{ "CPX", &c::CPX, &c::ABS, 4 },{ "SBC", &c::SBC, &c::ABS, 4 },{ "INC", &c::INC, &c::ABS, 6 },{ "ISB", &c::ISB, &c::ABS, 6 },
-/*  Fx  */	{ "BEQ", &c::BEQ, &c::REL, 2 },{ "SBC", &c::SBC, &c::IZY, 5 },{ "???", &c::XXX, &c::IMP, 2 },{ "ISB", &c::ISB, &c::IZY, 8 },{ "NOP", &c::NOP, &c::ZPX, 4 },{ "SBC", &c::SBC, &c::ZPX, 4 },{ "INC", &c::INC, &c::ZPX, 6 },{ "ISB", &c::ISB, &c::ZPX, 6 },{ "SED", &c::SED, &c::IMP, 2 },{ "SBC", &c::SBC, &c::ABY, 4 },{ "NOP", &c::NOP, &c::IMP, 2 },{ "ISB", &c::ISB, &c::ABY, 7 },{ "NOP", &c::NOP, &c::ABX, 4 },{ "SBC", &c::SBC, &c::ABX, 4 },{ "INC", &c::INC, &c::ABX, 7 },{ "ISB", &c::ISB, &c::ABX, 7 },
-};
+// Addressing temporaries don't outlive an instruction, so the
+// registers and the cycles still owed by tick() are enough
+template <typename busType>
+void CPU_6502<busType>::serialize(StateWriter& writer) {
+	writer.write(A);
+	writer.write(X);
+	writer.write(Y);
+	writer.write(SP);
+	writer.write(PC);
+	writer.write(PS.data);
+	writer.write(cycles);
+	writer.write((uint64_t)totalCyclesPassed);
+}
+
+template <typename busType>
+void CPU_6502<busType>::deserialize(StateReader& reader) {
+	uint64_t cyclesPassed = 0;
+
+	reader.read(A);
+	reader.read(X);
+	reader.read(Y);
+	reader.read(SP);
+	reader.read(PC);
+	reader.read(PS.data);
+	reader.read(cycles);
+	reader.read(cyclesPassed);
+
+	totalCyclesPassed = (size_t)cyclesPassed;
+}
+
+//	+-----------------------+
+//	|	  Lookup Table		|
+//	+-----------------------+
+
+template <typename busType>
+const std::array<typename CPU_6502<busType>::CpuInstruction, 256> CPU_6502<busType>::lookup = {{
+//			|         x0         |         x1         |         x2         |         x3         |         x4         |         x5         |         x6         |         x7         |         x8         |         x9         |         xA         |         xB         |         xC         |         xD         |         xE         |         xF         |
+/*  0x  */	{ &c::BRK, &c::IMM },{ &c::ORA, &c::IZX },{ &c::XXX, &c::IMP },{ &c::SLO, &c::IZX },{ &c::NOP, &c::ZP0 },{ &c::ORA, &c::ZP0 },{ &c::ASL, &c::ZP0 },{ &c::SLO, &c::ZP0 },{ &c::PHP, &c::IMP },{ &c::ORA, &c::IMM },{ &c::ASL, &c::IMP },{ &c::XXX, &c::IMP },{ &c::NOP, &c::ABS },{ &c::ORA, &c::ABS },{ &c::ASL, &c::ABS },{ &c::SLO, &c::ABS },
+/*  1x  */	{ &c::BPL, &c::REL },{ &c::ORA, &c::IZY },{ &c::XXX, &c::IMP },{ &c::SLO, &c::IZY },{ &c::NOP, &c::ZPX },{ &c::ORA, &c::ZPX },{ &c::ASL, &c::ZPX },{ &c::SLO, &c::ZPX },{ &c::CLC, &c::IMP },{ &c::ORA, &c::ABY },{ &c::NOP, &c::IMP },{ &c::SLO, &c::ABY },{ &c::NOP, &c::ABX },{ &c::ORA, &c::ABX },{ &c::ASL, &c::ABX },{ &c::SLO, &c::ABX },
+/*  2x  */	{ &c::JSR, &c::ABS },{ &c::AND, &c::IZX },{ &c::XXX, &c::IMP },{ &c::RLA, &c::IZX },{ &c::BIT, &c::ZP0 },{ &c::AND, &c::ZP0 },{ &c::ROL, &c::ZP0 },{ &c::RLA, &c::ZP0 },{ &c::PLP, &c::IMP },{ &c::AND, &c::IMM },{ &c::ROL, &c::IMP },{ &c::XXX, &c::IMP },{ &c::BIT, &c::ABS },{ &c::AND, &c::ABS },{ &c::ROL, &c::ABS },{ &c::RLA, &c::ABS },
+/*  3x  */	{ &c::BMI, &c::REL },{ &c::AND, &c::IZY },{ &c::XXX, &c::IMP },{ &c::RLA, &c::IZY },{ &c::NOP, &c::ZPX },{ &c::AND, &c::ZPX },{ &c::ROL, &c::ZPX },{ &c::RLA, &c::ZPX },{ &c::SEC, &c::IMP },{ &c::AND, &c::ABY },{ &c::NOP, &c::IMP },{ &c::RLA, &c::ABY },{ &c::NOP, &c::ABX },{ &c::AND, &c::ABX },{ &c::ROL, &c::ABX },{ &c::RLA, &c::ABX },
+/*  4x  */	{ &c::RTI, &c::IMP },{ &c::EOR, &c::IZX },{ &c::XXX, &c::IMP },{ &c::SRE, &c::IZX },{ &c::NOP, &c::ZP0 },{ &c::EOR, &c::ZP0 },{ &c::LSR, &c::ZP0 },{ &c::SRE, &c::ZP0 },{ &c::PHA, &c::IMP },{ &c::EOR, &c::IMM },{ &c::LSR, &c::IMP },{ &c::XXX, &c::IMP },{ &c::JMP, &c::ABS },{ &c::EOR, &c::ABS },{ &c::LSR, &c::ABS },{ &c::SRE, &c::ABS },
+/*  5x  */	{ &c::BVC, &c::REL },{ &c::EOR, &c::IZY },{ &c::XXX, &c::IMP },{ &c::SRE, &c::IZY },{ &c::NOP, &c::ZPX },{ &c::EOR, &c::ZPX },{ &c::LSR, &c::ZPX },{ &c::SRE, &c::ZPX },{ &c::CLI, &c::IMP },{ &c::EOR, &c::ABY },{ &c::NOP, &c::IMP },{ &c::SRE, &c::ABY },{ &c::NOP, &c::ABX },{ &c::EOR, &c::ABX },{ &c::LSR, &c::ABX },{ &c::SRE, &c::ABX },
+/*  6x  */	{ &c::RTS, &c::IMP },{ &c::ADC, &c::IZX },{ &c::XXX, &c::IMP },{ &c::RRA, &c::IZX },{ &c::NOP, &c::ZP0 },{ &c::ADC, &c::ZP0 },{ &c::ROR, &c::ZP0 },{ &c::RRA, &c::ZP0 },{ &c::PLA, &c::IMP },{ &c::ADC, &c::IMM },{ &c::ROR, &c::IMP },{ &c::XXX, &c::IMP },{ &c::JMP, &c::IND },{ &c::ADC, &c::ABS },{ &c::ROR, &c::ABS },{ &c::RRA, &c::ABS },
+/*  7x  */	{ &c::BVS, &c::REL },{ &c::ADC, &c::IZY },{ &c::XXX, &c::IMP },{ &c::RRA, &c::IZY },{ &c::NOP, &c::ZPX },{ &c::ADC, &c::ZPX },{ &c::ROR, &c::ZPX },{ &c::RRA, &c::ZPX },{ &c::SEI, &c::IMP },{ &c::ADC, &c::ABY },{ &c::NOP, &c::IMP },{ &c::RRA, &c::ABY },{ &c::NOP, &c::ABX },{ &c::ADC, &c::ABX },{ &c::ROR, &c::ABX },{ &c::RRA, &c::ABX },
+/*  8x  */	{ &c::NOP, &c::IMM },{ &c::STA, &c::IZX },{ &c::NOP, &c::IMP },{ &c::SAX, &c::IZX },{ &c::STY, &c::ZP0 },{ &c::STA, &c::ZP0 },{ &c::STX, &c::ZP0 },{ &c::SAX, &c::ZP0 },{ &c::DEY, &c::IMP },{ &c::NOP, &c::IMP },{ &c::TXA, &c::IMP },{ &c::XXX, &c::IMP },{ &c::STY, &c::ABS },{ &c::STA, &c::ABS },{ &c::STX, &c::ABS },{ &c::SAX, &c::ABS },
+/*  9x  */	{ &c::BCC, &c::REL },{ &c::STA, &c::IZY },{ &c::XXX, &c::IMP },{ &c::XXX, &c::IMP },{ &c::STY, &c::ZPX },{ &c::STA, &c::ZPX },{ &c::STX, &c::ZPY },{ &c::SAX, &c::ZPY },{ &c::TYA, &c::IMP },{ &c::STA, &c::ABY },{ &c::TXS, &c::IMP },{ &c::XXX, &c::IMP },{ &c::NOP, &c::ABX },{ &c::STA, &c::ABX },{ &c::XXX, &c::IMP },{ &c::XXX, &c::IMP },
+/*  Ax  */	{ &c::LDY, &c::IMM },{ &c::LDA, &c::IZX },{ &c::LDX, &c::IMM },{ &c::LAX, &c::IZX },{ &c::LDY, &c::ZP0 },{ &c::LDA, &c::ZP0 },{ &c::LDX, &c::ZP0 },{ &c::LAX, &c::ZP0 },{ &c::TAY, &c::IMP },{ &c::LDA, &c::IMM },{ &c::TAX, &c::IMP },{ &c::XXX, &c::IMP },{ &c::LDY, &c::ABS },{ &c::LDA, &c::ABS },{ &c::LDX, &c::ABS },{ &c::LAX, &c::ABS },
+/*  Bx  */	{ &c::BCS, &c::REL },{ &c::LDA, &c::IZY },{ &c::XXX, &c::IMP },{ &c::LAX, &c::IZY },{ &c::LDY, &c::ZPX },{ &c::LDA, &c::ZPX },{ &c::LDX, &c::ZPY },{ &c::LAX, &c::ZPY },{ &c::CLV, &c::IMP },{ &c::LDA, &c::ABY },{ &c::TSX, &c::IMP },{ &c::XXX, &c::IMP },{ &c::LDY, &c::ABX },{ &c::LDA, &c::ABX },{ &c::LDX, &c::ABY },{ &c::LAX, &c::ABY },
+/*  Cx  */	{ &c::CPY, &c::IMM },{ &c::CMP, &c::IZX },{ &c::NOP, &c::IMP },{ &c::DCP, &c::IZX },{ &c::CPY, &c::ZP0 },{ &c::CMP, &c::ZP0 },{ &c::DEC, &c::ZP0 },{ &c::DCP, &c::ZP0 },{ &c::INY, &c::IMP },{ &c::CMP, &c::IMM },{ &c::DEX, &c::IMP },{ &c::XXX, &c::IMP },{ &c::CPY, &c::ABS },{ &c::CMP, &c::ABS },{ &c::DEC, &c::ABS },{ &c::DCP, &c::ABS },
+/*  Dx  */	{ &c::BNE, &c::REL },{ &c::CMP, &c::IZY },{ &c::XXX, &c::IMP },{ &c::DCP, &c::IZY },{ &c::NOP, &c::ZPX },{ &c::CMP, &c::ZPX },{ &c::DEC, &c::ZPX },{ &c::DCP, &c::ZPX },{ &c::CLD, &c::IMP },{ &c::CMP, &c::ABY },{ &c::NOP, &c::IMP },{ &c::DCP, &c::ABY },{ &c::NOP, &c::ABX },{ &c::CMP, &c::ABX },{ &c::DEC, &c::ABX },{ &c::DCP, &c::ABX },
+/*  Ex  */	{ &c::CPX, &c::IMM },{ &c::SBC, &c::IZX },{ &c::NOP, &c::IMP },{ &c::ISB, &c::IZX },{ &c::CPX, &c::ZP0 },{ &c::SBC, &c::ZP0 },{ &c::INC, &c::ZP0 },{ &c::ISB, &c::ZP0 },{ &c::INX, &c::IMP },{ &c::SBC, &c::IMM },{ &c::NOP, &c::IMP },{ &c::SBC, &c::IMM },{ &c::CPX, &c::ABS },{ &c::SBC, &c::ABS },{ &c::INC, &c::ABS },{ &c::ISB, &c::ABS },
+/*  Fx  */	{ &c::BEQ, &c::REL },{ &c::SBC, &c::IZY },{ &c::XXX, &c::IMP },{ &c::ISB, &c::IZY },{ &c::NOP, &c::ZPX },{ &c::SBC, &c::ZPX },{ &c::INC, &c::ZPX },{ &c::ISB, &c::ZPX },{ &c::SED, &c::IMP },{ &c::SBC, &c::ABY },{ &c::NOP, &c::IMP },{ &c::ISB, &c::ABY },{ &c::NOP, &c::ABX },{ &c::SBC, &c::ABX },{ &c::INC, &c::ABX },{ &c::ISB, &c::ABX },
+}};
+
+
+//	+-----------------------+
+//	|	  Instantiations		|
+//	+-----------------------+
+
+#define INSTANTIATE(cpu) template class cpu;
+
+CPU_6502_INSTANTIATE(INSTANTIATE)
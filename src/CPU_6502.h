@@ -3,11 +3,13 @@
 #include <vector>
 #include <map>
 #include <fstream>
+#include <stdexcept>
 
 #include "fmt/format.h"
 
 #include "INesCpu.h"
 #include "IBusMaster.h"
+#include "CPU_6502_Opcodes.h"
 
 
 #define stackBase		0x0100
@@ -27,7 +29,11 @@
 #define checkCF(value) (PS.CF = ((value & 0x100) >> 8))
 
 
-class CPU_6502 final : public INesCpu {
+// The bus type is a compile time parameter so that CPUs built for a
+// concrete (final) bus can inline its accesses, CPU_6502<> talks to
+// any bus through the virtual interface.
+template <typename busType = IBus<uint16_t, uint8_t>>
+class CPU_6502 : public INesCpu {
 public:
 	void connectBus(std::shared_ptr<IBus<uint16_t, uint8_t>> bus) override;
 
@@ -35,13 +41,22 @@ public:
 	bool isFinished() override;
 	std::string getLog() override;
 
+	void serialize(StateWriter& writer) override;
+	void deserialize(StateReader& reader) override;
+
 	void reset(uint16_t pc) override;
 	void reset() override;
 	void irq()	 override;
 	void nmi()	 override;
 	void tick()	 override;
+	void setIrqLine(bool asserted) override { m_irqLine = asserted; }
+
+	size_t runCycles(size_t budget)	   override;
+	size_t runUntil(size_t targetCycle) override;
+	void endRun() override { m_targetCycle = 0; }
+	void stall(size_t nCycles) override { cycles += (uint16_t)nCycles; }
 
-private:
+protected:
 	//			+--------------------+
 	//			|   CPU Registers	 |
 	//			+--------------------+
@@ -104,19 +119,48 @@ private:
 	//			+--------------------+
 	//			|  Bus Functionality |
 	//			+--------------------+
-	inline uint8_t readFrom(uint16_t address, bool readOnly = false) override {
-		return m_bus->read(address, readOnly);
+	inline uint8_t readFrom(uint16_t address, bool readOnly = false) override final {
+		// RAM and ROM pages are plain loads, registers go through the bus
+		const DirectPage<uint16_t, uint8_t>& page =
+			m_directPages[address / IBus<uint16_t, uint8_t>::directPageSize];
+		if (page.data != nullptr)
+			return page.data[address & page.mask];
+
+		return m_typedBus->read(address, readOnly);
+	}
+
+	inline void writeTo(uint16_t address, uint8_t data) override final {
+		const DirectPage<uint16_t, uint8_t>& page =
+			m_directPages[address / IBus<uint16_t, uint8_t>::directPageSize];
+		if (page.writable) {
+			page.data[address & page.mask] = data;
+			return;
+		}
+
+		m_busWrite(address, data);
 	}
 
-	inline void writeTo(uint16_t address, uint8_t data) override {
-		m_bus->write(address, data);
+	// Writes that missed the direct pages, derived CPUs hook
+	// this to watch register writes and bank switches
+	virtual void m_busWrite(uint16_t address, uint8_t data) {
+		m_typedBus->write(address, data);
 	}
 
+	busType* m_typedBus = nullptr;
+
+	// Target of the running runUntil, endRun() zeroes it
+	size_t m_targetCycle = 0;
+	const DirectPage<uint16_t, uint8_t>* m_directPages = nullptr;
+
 	//			+--------------------+
 	//			|		Other		 |
 	//			+--------------------+
 
-	struct CpuInstruction;
+	struct CpuInstruction {
+		uint8_t(CPU_6502::* operation)(void);
+		uint8_t(CPU_6502::* addressMode)(void);
+	};
+	typedef CPU_6502 c;	// Shorthand for the lookup table
 
 
 	bool isIMP();
@@ -125,18 +169,28 @@ private:
 	uint8_t fetchData();
 	uint8_t fetchedData = 0x00;
 
+	void executeInstruction();
+	void dispatchInstruction();
+
 	uint16_t result = 0x0000;
 	uint16_t addressAbsolute = 0x0000;
 	uint16_t addressRelative = 0x0000;
 	uint8_t opcode = 0x00;
-	uint8_t cycles = 0;
+	uint16_t cycles = 0;	// Wide enough for an OAM DMA stall
 	size_t totalCyclesPassed = 0;
+	bool m_irqLine = false;
 
 
-	static std::vector<CpuInstruction> lookup;
+	static const std::array<CpuInstruction, 256> lookup;
 
-	std::string currentInstructionName;
 	fmt::memory_buffer debugBuffer;
 	fmt::memory_buffer logBuffer;
 	void log();
 };
+
+
+// Buses the CPU is compiled for, each CPU_6502*.cpp
+// instantiates the members it defines for all of them
+#define CPU_6502_INSTANTIATE(instantiate)	\
+	instantiate(CPU_6502<>)					\
+	instantiate(CPU_6502<NesPageTableBus>)
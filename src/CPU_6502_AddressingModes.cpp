@@ -3,17 +3,20 @@
 #include "fmt/core.h"
 
 #include "CPU_6502.h"
+#include "NesPageTableBus.h"
 #include "Config.h"
 
 
-void CPU_6502::log() {
+template <typename busType>
+void CPU_6502<busType>::log() {
 	fmt::format_to(logBuffer, "\n{:04X}  {:s}  A:{:02X} X:{:02X} Y:{:02X} P:{:02X} SP:{:02X} PPU:{:3d},{:3d} CYC:{:d}",
 		PC-1, fmt::to_string(debugBuffer), A, X, Y, PS.data, SP, 0, 0, totalCyclesPassed);
 
 	debugBuffer.clear();
 }
 
-std::string CPU_6502::getLog() {
+template <typename busType>
+std::string CPU_6502<busType>::getLog() {
 	std::string temp = fmt::to_string(logBuffer);
 	logBuffer.clear();
 
@@ -26,22 +29,23 @@ std::string CPU_6502::getLog() {
 //	+-----------------------+
 
 // Implied
-uint8_t CPU_6502::IMP() {
+template <typename busType>
+uint8_t CPU_6502<busType>::IMP() {
 	fetchedData = A;
 
 #ifdef _LOG
 	if (opcode == 0x4A || opcode == 0x0A || opcode == 0x6A || opcode == 0x2A) {
 		fmt::format_to(debugBuffer, "{:02X}        {:s} A                         ",
-			opcode, currentInstructionName);
+			opcode, opcodeTable[opcode].name);
 	}
 	else if (opcode == 0x1A || opcode == 0x3A || opcode == 0x5A || opcode == 0x7A ||
 		opcode == 0xDA || opcode == 0xFA) {
 		fmt::format_to(debugBuffer, "{:02X}       *{:s}                           ",
-			opcode, currentInstructionName);
+			opcode, opcodeTable[opcode].name);
 	}
 	else {
 		fmt::format_to(debugBuffer, "{:02X}        {:s}                           ",
-			opcode, currentInstructionName);
+			opcode, opcodeTable[opcode].name);
 	}
 	log();
 #endif
@@ -50,17 +54,18 @@ uint8_t CPU_6502::IMP() {
 }
 
 // Immediate
-uint8_t CPU_6502::IMM() {
+template <typename busType>
+uint8_t CPU_6502<busType>::IMM() {
 	addressAbsolute = PC;
 
 #ifdef _LOG
 	if (opcode == 0x80 || opcode == 0xEB) {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}    *{:s} #${:02X}                      ",
-			opcode, readFrom(addressAbsolute, true), currentInstructionName, readFrom(addressAbsolute, true));
+			opcode, readFrom(addressAbsolute, true), opcodeTable[opcode].name, readFrom(addressAbsolute, true));
 	}
 	else {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}     {:s} #${:02X}                      ",
-			opcode, readFrom(addressAbsolute, true), currentInstructionName, readFrom(addressAbsolute, true));
+			opcode, readFrom(addressAbsolute, true), opcodeTable[opcode].name, readFrom(addressAbsolute, true));
 	}
 	log();
 #endif
@@ -71,7 +76,8 @@ uint8_t CPU_6502::IMM() {
 }
 
 // Zero Page
-uint8_t CPU_6502::ZP0() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ZP0() {
 	addressAbsolute = readFrom(PC);
 	addressAbsolute &= 0x00FF;
 
@@ -82,11 +88,11 @@ uint8_t CPU_6502::ZP0() {
 	result = readFrom(PC, true);
 
 	fmt::format_to(debugBuffer, "{:02X} {:02X}    *{:s} ${:02X} = {:02X}                  ",
-		opcode, result, currentInstructionName, result, readFrom(result, true));
+		opcode, result, opcodeTable[opcode].name, result, readFrom(result, true));
 	}
 	else {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}     {:s} ${:02X} = {:02X}                  ",
-			opcode, addressAbsolute, currentInstructionName, addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, addressAbsolute, opcodeTable[opcode].name, addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	log();
 #endif
@@ -97,7 +103,8 @@ uint8_t CPU_6502::ZP0() {
 }
 
 // Zero Page - X Offset
-uint8_t CPU_6502::ZPX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ZPX() {
 	addressAbsolute = (readFrom(PC) + X);
 	addressAbsolute &= 0x00FF;
 
@@ -107,11 +114,11 @@ uint8_t CPU_6502::ZPX() {
 		opcode == 0xD4 || opcode == 0xF4 || opcode == 0xD7 || opcode == 0xF7 ||
 		opcode == 0x17 || opcode == 0x37 || opcode == 0x57 || opcode == 0x77) {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}    *{:s} ${:02X},X @ {:02X} = {:02X}           ",
-			opcode, result, currentInstructionName, result, addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, result, opcodeTable[opcode].name, result, addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	else {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}     {:s} ${:02X},X @ {:02X} = {:02X}           ",
-			opcode, result, currentInstructionName, result, addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, result, opcodeTable[opcode].name, result, addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	log();
 #endif
@@ -122,7 +129,8 @@ uint8_t CPU_6502::ZPX() {
 }
 
 // Zero Page - Y Offset
-uint8_t CPU_6502::ZPY() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ZPY() {
 	addressAbsolute = (readFrom(PC) + Y);
 	addressAbsolute &= 0x00FF;
 
@@ -131,11 +139,11 @@ uint8_t CPU_6502::ZPY() {
 
 	if (opcode == 0xB7 || opcode == 0x97) {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}    *{:s} ${:02X},Y @ {:02X} = {:02X}           ",
-			opcode, result, currentInstructionName, result, addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, result, opcodeTable[opcode].name, result, addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	else {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}     {:s} ${:02X},Y @ {:02X} = {:02X}           ",
-			opcode, result, currentInstructionName, result, addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, result, opcodeTable[opcode].name, result, addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	log();
 #endif
@@ -146,7 +154,8 @@ uint8_t CPU_6502::ZPY() {
 }
 
 // Absolute
-uint8_t CPU_6502::ABS() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ABS() {
 	uint16_t lo = readFrom(PC);
 	uint16_t hi = readFrom(PC+1);
 	addressAbsolute = (hi << 8) | lo;
@@ -156,15 +165,15 @@ uint8_t CPU_6502::ABS() {
 		opcode == 0xEF || opcode == 0x0F || opcode == 0x2F || opcode == 0x4F ||
 		opcode == 0x6F) {
 		fmt::format_to(debugBuffer, "{:02X} {:02X} {:02X} *{:s} ${:04X} = {:02X}                ",
-			opcode, lo, hi, currentInstructionName, addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, lo, hi, opcodeTable[opcode].name, addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	else if (opcode ==  0x4C || opcode == 0x20) {
 		fmt::format_to(debugBuffer, "{:02X} {:02X} {:02X}  {:s} ${:04X}                     ",
-			opcode, lo, hi, currentInstructionName, addressAbsolute);
+			opcode, lo, hi, opcodeTable[opcode].name, addressAbsolute);
 	}
 	else {
 		fmt::format_to(debugBuffer, "{:02X} {:02X} {:02X}  {:s} ${:04X} = {:02X}                ",
-			opcode, lo, hi, currentInstructionName, addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, lo, hi, opcodeTable[opcode].name, addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	log();
 #endif
@@ -175,7 +184,8 @@ uint8_t CPU_6502::ABS() {
 }
 
 // Absolute - X Offset
-uint8_t CPU_6502::ABX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ABX() {
 	uint16_t lo = readFrom(PC);
 	uint16_t hi = readFrom(PC+1);
 	addressAbsolute = (hi << 8) | lo;
@@ -188,12 +198,12 @@ uint8_t CPU_6502::ABX() {
 		opcode == 0xFC || opcode == 0xDF || opcode == 0xFF || opcode == 0x1F || opcode == 0x3F ||
 		opcode == 0x5F || opcode == 0x7F) {
 		fmt::format_to(debugBuffer, "{:02X} {:02X} {:02X} *{:s} ${:04X},X @ {:04X} = {:02X}       ",
-			opcode, lo, hi, currentInstructionName, result,
+			opcode, lo, hi, opcodeTable[opcode].name, result,
 			addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	else {
 		fmt::format_to(debugBuffer, "{:02X} {:02X} {:02X}  {:s} ${:04X},X @ {:04X} = {:02X}       ",
-			opcode, lo, hi, currentInstructionName, result,
+			opcode, lo, hi, opcodeTable[opcode].name, result,
 			addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	log();
@@ -208,7 +218,8 @@ uint8_t CPU_6502::ABX() {
 }
 
 // Absolute - Y Offset
-uint8_t CPU_6502::ABY() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ABY() {
 	uint16_t lo = readFrom(PC);
 	uint16_t hi = readFrom(PC + 1);
 	addressAbsolute = (hi << 8) | lo;
@@ -220,11 +231,11 @@ uint8_t CPU_6502::ABY() {
 	if (opcode == 0xBF || opcode == 0xDB || opcode == 0xFB || opcode == 0x1B || opcode == 0x3B ||
 		opcode == 0x5B || opcode == 0x7B) {
 		fmt::format_to(debugBuffer, "{:02X} {:02X} {:02X} *{:s} ${:04X},Y @ {:04X} = {:02X}       ",
-			opcode, lo, hi, currentInstructionName, result, addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, lo, hi, opcodeTable[opcode].name, result, addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	else {
 		fmt::format_to(debugBuffer, "{:02X} {:02X} {:02X}  {:s} ${:04X},Y @ {:04X} = {:02X}       ",
-			opcode, lo, hi, currentInstructionName, result, addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, lo, hi, opcodeTable[opcode].name, result, addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	log();
 #endif
@@ -238,7 +249,8 @@ uint8_t CPU_6502::ABY() {
 }
 
 // Indirect
-uint8_t CPU_6502::IND() {
+template <typename busType>
+uint8_t CPU_6502<busType>::IND() {
 	uint16_t ptrLo = readFrom(PC);
 	uint16_t ptrHi = readFrom(PC+1);
 	uint16_t ptr = (ptrHi << 8) | ptrLo;
@@ -255,7 +267,7 @@ uint8_t CPU_6502::IND() {
 
 #ifdef _LOG
 	fmt::format_to(debugBuffer, "{:02X} {:02X} {:02X}  {:s} (${:04X}) = {:04X}            ",
-		opcode, ptrLo, ptrHi, currentInstructionName, ptr, addressAbsolute);
+		opcode, ptrLo, ptrHi, opcodeTable[opcode].name, ptr, addressAbsolute);
 	log();
 #endif
 
@@ -265,7 +277,8 @@ uint8_t CPU_6502::IND() {
 }
 
 // Indirect - X Offset
-uint8_t CPU_6502::IZX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::IZX() {
 	result = readFrom(PC);
 	uint16_t lo = readFrom(lowByte((uint16_t)(result + (uint16_t)X)));
 	uint16_t hi = readFrom(lowByte((uint16_t)(result + (uint16_t)X + 1)));
@@ -276,11 +289,11 @@ uint8_t CPU_6502::IZX() {
 	if (opcode == 0xA3 || opcode == 0x83 || opcode == 0xC3 || opcode == 0xE3 || opcode == 0x03 ||
 		opcode == 0x23 || opcode == 0x43 || opcode == 0x63) {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}    *{:s} (${:02X},X) @ {:02X} = {:04X} = {:02X}  ",
-			opcode, result, currentInstructionName, result, lowByte(result + X), addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, result, opcodeTable[opcode].name, result, lowByte(result + X), addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	else {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}     {:s} (${:02X},X) @ {:02X} = {:04X} = {:02X}  ",
-			opcode, result, currentInstructionName, result, lowByte(result + X), addressAbsolute, readFrom(addressAbsolute, true));
+			opcode, result, opcodeTable[opcode].name, result, lowByte(result + X), addressAbsolute, readFrom(addressAbsolute, true));
 	}
 	log();
 #endif
@@ -291,7 +304,8 @@ uint8_t CPU_6502::IZX() {
 }
 
 // Indirect - Y Offset
-uint8_t CPU_6502::IZY() {
+template <typename busType>
+uint8_t CPU_6502<busType>::IZY() {
 	result = readFrom(PC);
 	uint16_t lo = readFrom(lowByte(result));
 	uint16_t hi = readFrom(lowByte(result + 1));
@@ -302,12 +316,12 @@ uint8_t CPU_6502::IZY() {
 	if (opcode == 0xA3 || opcode == 0xB3 || opcode == 0xD3 || opcode == 0xF3 || opcode == 0x13 || opcode == 0x33 ||
 		opcode == 0x53 || opcode == 0x73) {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}    *{:s} (${:02X}),Y = {:04X} @ {:04X} = {:02X}",
-			opcode, result, currentInstructionName, result, addressAbsolute,
+			opcode, result, opcodeTable[opcode].name, result, addressAbsolute,
 			(addressAbsolute + Y) & 0xFFFF, readFrom((addressAbsolute + Y) & 0xFFFF, true));
 	}
 	else {
 		fmt::format_to(debugBuffer, "{:02X} {:02X}     {:s} (${:02X}),Y = {:04X} @ {:04X} = {:02X}",
-			opcode, result, currentInstructionName, result, addressAbsolute,
+			opcode, result, opcodeTable[opcode].name, result, addressAbsolute,
 			(addressAbsolute + Y) & 0xFFFF, readFrom((addressAbsolute + Y) & 0xFFFF, true));
 	}
 	log();
@@ -326,7 +340,8 @@ uint8_t CPU_6502::IZY() {
 }
 
 // Relative
-uint8_t CPU_6502::REL() {
+template <typename busType>
+uint8_t CPU_6502<busType>::REL() {
 	addressRelative = readFrom(PC);
 
 	if (addressRelative & 0x80)
@@ -334,7 +349,7 @@ uint8_t CPU_6502::REL() {
 
 #ifdef _LOG
 	fmt::format_to(debugBuffer, "{:02X} {:02X}     {:s} ${:04X}                     ",
-		opcode, readFrom(PC, true), currentInstructionName, (PC+1 + addressRelative) & 0xFFFF);
+		opcode, readFrom(PC, true), opcodeTable[opcode].name, (PC+1 + addressRelative) & 0xFFFF);
 	log();
 #endif
 
@@ -342,3 +357,16 @@ uint8_t CPU_6502::REL() {
 
 	return 0;
 }
+
+
+//	+-----------------------+
+//	|	  Instantiations		|
+//	+-----------------------+
+
+#define INSTANTIATE(cpu) \
+	template void cpu::log(); template std::string cpu::getLog(); template uint8_t cpu::IMP(); template uint8_t cpu::IMM(); \
+	template uint8_t cpu::ZP0(); template uint8_t cpu::ZPX(); template uint8_t cpu::ZPY(); template uint8_t cpu::ABS(); \
+	template uint8_t cpu::ABX(); template uint8_t cpu::ABY(); template uint8_t cpu::IND(); template uint8_t cpu::IZX(); \
+	template uint8_t cpu::IZY(); template uint8_t cpu::REL();
+
+CPU_6502_INSTANTIATE(INSTANTIATE)
@@ -0,0 +1,420 @@
+#include "CPU_6502_Cached.h"
+#include "NesPageTableBus.h"
+#include "Config.h"
+
+
+template <typename busType>
+void CPU_6502_Cached<busType>::connectBus(std::shared_ptr<IBus<uint16_t, uint8_t>> bus) {
+	CPU_6502<busType>::connectBus(bus);
+
+	// Route the CPU's accesses through our copy of the table
+	m_busPages = this->m_directPages;
+	this->m_directPages = m_cpuPages.data();
+
+	m_flush();
+}
+
+template <typename busType>
+void CPU_6502_Cached<busType>::reset() {
+	m_flush();
+	CPU_6502<busType>::reset();
+}
+
+template <typename busType>
+void CPU_6502_Cached<busType>::reset(uint16_t pc) {
+	m_flush();
+	CPU_6502<busType>::reset(pc);
+}
+
+template <typename busType>
+void CPU_6502_Cached<busType>::irq() {
+	CPU_6502<busType>::irq();
+	m_block = nullptr;
+}
+
+template <typename busType>
+void CPU_6502_Cached<busType>::nmi() {
+	CPU_6502<busType>::nmi();
+	m_block = nullptr;
+}
+
+template <typename busType>
+void CPU_6502_Cached<busType>::tick() {
+	if (this->cycles == 0) {
+		if (this->m_irqLine && this->PS.ID == 0)
+			irq();
+		else
+			m_executeInstruction();
+	}
+
+	this->totalCyclesPassed++;
+	this->cycles--;
+}
+
+template <typename busType>
+size_t CPU_6502_Cached<busType>::runUntil(size_t targetCycle) {
+	// Account for what tick() or an interrupt left in flight
+	this->totalCyclesPassed += this->cycles;
+	this->cycles = 0;
+
+	this->m_targetCycle = targetCycle;
+	while (this->totalCyclesPassed < this->m_targetCycle) {
+		if (this->m_irqLine && this->PS.ID == 0) {
+			irq();
+
+			this->totalCyclesPassed += this->cycles;
+			this->cycles = 0;
+			continue;
+		}
+
+		m_executeInstruction();
+
+		this->totalCyclesPassed += this->cycles;
+		this->cycles = 0;
+	}
+
+	return (this->totalCyclesPassed > targetCycle) ? this->totalCyclesPassed - targetCycle : 0;
+}
+
+// Memory was replaced behind our back, nothing decoded from it holds
+template <typename busType>
+void CPU_6502_Cached<busType>::deserialize(StateReader& reader) {
+	CPU_6502<busType>::deserialize(reader);
+	m_flush();
+}
+
+
+//	+-----------------------+
+//	|	   Block Execution		|
+//	+-----------------------+
+
+// Runs the next micro-op of the current block, leaves the
+// instruction's length in cycles in "cycles" like executeInstruction
+template <typename busType>
+void CPU_6502_Cached<busType>::m_executeInstruction() {
+	if (m_block == nullptr || m_blockIndex == m_block->ops.size() ||
+		m_block->ops[m_blockIndex].pc != this->PC) {
+
+		m_block = m_findBlock(this->PC);
+		m_blockIndex = 0;
+
+		// Not cacheable, interpret it
+		if (m_block == nullptr) {
+			this->executeInstruction();
+			return;
+		}
+	}
+
+	// Copied, the instruction can drop its own block by writing to it
+	const MicroOp op = m_block->ops[m_blockIndex++];
+
+	this->opcode = op.opcode;
+	this->PS.XX = 1;
+	this->cycles = op.cycles;
+	this->PC = op.nextPc;
+
+	uint8_t additionalCycles = 0;
+
+#ifdef _LOG
+	// Trace builds run the regular addressing modes so they can log
+	this->PC = op.pc + 1;
+	additionalCycles = (this->*CPU_6502<busType>::lookup[op.opcode].addressMode)();
+	additionalCycles &= (this->*CPU_6502<busType>::lookup[op.opcode].operation)();
+#else
+#define OPCODE(code, operation, addressMode)					\
+	case code:													\
+		additionalCycles = m_##addressMode(op);					\
+		additionalCycles &= this->operation();					\
+		break;
+
+	switch (op.opcode) {
+#include "CPU_6502_OpcodeList.inl"
+	}
+
+#undef OPCODE
+#endif
+
+	this->cycles += additionalCycles;
+
+	this->PS.XX = 1;
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_IMP(const MicroOp& op) {
+	this->fetchedData = this->A;
+	return 0;
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_IMM(const MicroOp& op) {
+	this->addressAbsolute = op.operand;
+	return 0;
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_ZP0(const MicroOp& op) {
+	this->addressAbsolute = op.operand;
+	return 0;
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_ZPX(const MicroOp& op) {
+	this->addressAbsolute = (op.operand + this->X) & 0x00FF;
+	return 0;
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_ZPY(const MicroOp& op) {
+	this->addressAbsolute = (op.operand + this->Y) & 0x00FF;
+	return 0;
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_REL(const MicroOp& op) {
+	this->addressRelative = op.operand;
+	return 0;
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_ABS(const MicroOp& op) {
+	this->addressAbsolute = op.operand;
+	return 0;
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_ABX(const MicroOp& op) {
+	this->addressAbsolute = op.operand + this->X;
+	return (this->addressAbsolute & 0xFF00) != (op.operand & 0xFF00);
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_ABY(const MicroOp& op) {
+	this->addressAbsolute = op.operand + this->Y;
+	return (this->addressAbsolute & 0xFF00) != (op.operand & 0xFF00);
+}
+
+// Pointers live in memory, so the indirect modes
+// run the regular ones from the operand onwards
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_IND(const MicroOp& op) {
+	this->PC = op.pc + 1;
+	return this->IND();
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_IZX(const MicroOp& op) {
+	this->PC = op.pc + 1;
+	return this->IZX();
+}
+
+template <typename busType>
+uint8_t CPU_6502_Cached<busType>::m_IZY(const MicroOp& op) {
+	this->PC = op.pc + 1;
+	return this->IZY();
+}
+
+// Returns the block starting at pc, building it on first use,
+// nullptr if the code there can't be cached
+template <typename busType>
+typename CPU_6502_Cached<busType>::Block* CPU_6502_Cached<busType>::m_findBlock(uint16_t pc) {
+	size_t pageIndex = pc / pageSize;
+
+	CodePage* codePage = m_mappedCode[pageIndex];
+	if (codePage == nullptr) {
+		codePage = m_mapCodePage(pageIndex);
+
+		if (codePage == nullptr)
+			return nullptr;
+	}
+
+	std::unique_ptr<Block>& block = codePage->blocks[pc % pageSize];
+	if (block == nullptr) {
+		block = m_buildBlock(pc, *codePage);
+
+		if (block == nullptr)
+			return nullptr;
+
+		for (size_t offset = pc % pageSize; offset < pc % pageSize + block->size; offset++)
+			codePage->coverage[offset]++;
+
+		// Write protect RAM holding code so changes to it drop the blocks
+		if (m_busPages[pageIndex].writable && m_ramCode.insert(codePage->memory).second)
+			m_refreshDirectPages();
+	}
+
+	return block.get();
+}
+
+// Looks up the decoded code for the memory currently mapped at the page
+template <typename busType>
+typename CPU_6502_Cached<busType>::CodePage* CPU_6502_Cached<busType>::m_mapCodePage(size_t pageIndex) {
+	const DirectPage<uint16_t, uint8_t>& page = m_busPages[pageIndex];
+
+	// Registers and memory smaller than a page are never cached
+	if (page.data == nullptr || (page.mask & 0x00FF) != 0x00FF)
+		return nullptr;
+
+	const uint8_t* memory = page.data + ((pageIndex * pageSize) & page.mask);
+
+	std::unique_ptr<CodePage>& codePage = m_codePages[std::make_pair(memory, pageIndex)];
+	if (codePage == nullptr) {
+		codePage = std::make_unique<CodePage>();
+		codePage->memory = memory;
+	}
+
+	m_mappedCode[pageIndex] = codePage.get();
+
+	return codePage.get();
+}
+
+// Decodes instructions from pc until control flow leaves the straight
+// line, the page ends or the block reaches its maximum length
+template <typename busType>
+std::unique_ptr<typename CPU_6502_Cached<busType>::Block>
+CPU_6502_Cached<busType>::m_buildBlock(uint16_t pc, const CodePage& codePage) {
+	std::unique_ptr<Block> block = std::make_unique<Block>();
+	size_t offset = pc % pageSize;
+
+	while (block->ops.size() < maxBlockLength) {
+		uint8_t opcode = codePage.memory[offset];
+		const OpcodeInfo& info = opcodeTable[opcode];
+		uint8_t length = instructionLength(info.addressMode);
+
+		// Operands in the next page may belong to another bank
+		if (offset + length > pageSize)
+			break;
+
+		uint16_t lo = (length > 1) ? codePage.memory[offset + 1] : 0x00;
+		uint16_t hi = (length > 2) ? codePage.memory[offset + 2] : 0x00;
+
+		MicroOp op;
+		op.pc = pc;
+		op.nextPc = pc + length;
+		op.opcode = opcode;
+		op.cycles = info.cycles;
+
+		switch (info.addressMode) {
+		case ADDRESS_MODE::IMM:
+			op.operand = pc + 1;
+			break;
+		case ADDRESS_MODE::REL:
+			op.operand = (lo & 0x80) ? (lo | 0xFF00) : lo;
+			break;
+		default:
+			op.operand = (hi << 8) | lo;
+			break;
+		}
+
+		block->ops.push_back(op);
+
+		pc += length;
+		offset += length;
+
+		if (isControlFlow(opcode) || offset >= pageSize)
+			break;
+	}
+
+	if (block->ops.empty())
+		return nullptr;
+
+	block->size = (uint16_t)(block->ops.back().nextPc - block->ops.front().pc);
+
+	return block;
+}
+
+
+//	+-----------------------+
+//	|	   Invalidation		|
+//	+-----------------------+
+
+template <typename busType>
+void CPU_6502_Cached<busType>::m_busWrite(uint16_t address, uint8_t data) {
+	const DirectPage<uint16_t, uint8_t>& page = m_busPages[address / pageSize];
+
+	// RAM we protected, the write may land on cached code
+	if (page.writable) {
+		page.data[address & page.mask] = data;
+		m_invalidateMemory(page.data + ((address & page.mask) & ~(pageSize - 1)), address % pageSize);
+		return;
+	}
+
+	uint32_t version = this->m_typedBus->mappingVersion();
+
+	this->m_typedBus->write(address, data);
+
+	// The write switched banks, the bus has
+	// remapped its pages so pick up the new ones
+	if (this->m_typedBus->mappingVersion() != version) {
+		m_refreshDirectPages();
+		m_block = nullptr;
+	}
+}
+
+// Copies the bus's direct pages, write protecting RAM that holds code
+template <typename busType>
+void CPU_6502_Cached<busType>::m_refreshDirectPages() {
+	if (m_busPages == nullptr)
+		return;
+
+	for (size_t pageIndex = 0; pageIndex < pageCount; pageIndex++) {
+		DirectPage<uint16_t, uint8_t>& page = m_cpuPages[pageIndex];
+		page = m_busPages[pageIndex];
+
+		if (page.writable &&
+			m_ramCode.count(page.data + ((pageIndex * pageSize) & page.mask)))
+			page.writable = false;
+	}
+
+	m_mappedCode.fill(nullptr);
+}
+
+// Drops the blocks decoded from a page of RAM that cover the byte at
+// offset, at every address it's mirrored to. The page stays protected.
+template <typename busType>
+void CPU_6502_Cached<busType>::m_invalidateMemory(const uint8_t* memory, size_t offset) {
+	for (auto entry = m_codePages.lower_bound(std::make_pair(memory, (size_t)0));
+		entry != m_codePages.end() && entry->first.first == memory; entry++) {
+
+		CodePage& codePage = *entry->second;
+		if (codePage.coverage[offset] == 0)
+			continue;
+
+		// Only blocks starting up to a block's size before can reach it
+		size_t first = (offset >= maxBlockSize) ? offset - maxBlockSize + 1 : 0;
+
+		for (size_t start = first; start <= offset; start++) {
+			const std::unique_ptr<Block>& block = codePage.blocks[start];
+
+			if (block != nullptr && start + block->size > offset)
+				m_dropBlock(codePage, start);
+		}
+
+		m_block = nullptr;
+	}
+}
+
+template <typename busType>
+void CPU_6502_Cached<busType>::m_dropBlock(CodePage& codePage, size_t offset) {
+	for (size_t byte = offset; byte < offset + codePage.blocks[offset]->size; byte++)
+		codePage.coverage[byte]--;
+
+	codePage.blocks[offset].reset();
+}
+
+template <typename busType>
+void CPU_6502_Cached<busType>::m_flush() {
+	m_codePages.clear();
+	m_ramCode.clear();
+	m_refreshDirectPages();
+
+	m_block = nullptr;
+}
+
+
+//	+-----------------------+
+//	|	  Instantiations		|
+//	+-----------------------+
+
+#define INSTANTIATE(cpu) template class cpu;
+
+CPU_6502_CACHED_INSTANTIATE(INSTANTIATE)
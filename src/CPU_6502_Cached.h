@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+
+#include "CPU_6502.h"
+
+
+// CPU_6502 that decodes every basic block it runs into micro-ops once and
+// replays them afterwards. Opcodes, operands and base cycles are resolved
+// when the block is built, only the indexed and indirect addressing modes
+// are still computed at run time. Execution stays one instruction at a time
+// so it can be swapped in for CPU_6502 and compared cycle for cycle.
+//
+// Only code on direct pages is cached. Blocks are keyed by the host memory
+// of their page (so by mapper bank for ROM) and the PC, a bank switch just
+// selects other blocks. RAM pages holding blocks are write protected in a
+// copy of the bus's direct page table, CPU writes to them drop the blocks
+// covering the written byte. The copy is taken on connectBus and reset (so
+// map slaves before resetting the CPU) and again when the bus remaps pages.
+template <typename busType = IBus<uint16_t, uint8_t>>
+class CPU_6502_Cached final : public CPU_6502<busType> {
+public:
+	void connectBus(std::shared_ptr<IBus<uint16_t, uint8_t>> bus) override;
+
+	void reset(uint16_t pc) override;
+	void reset() override;
+	void irq()	 override;
+	void nmi()	 override;
+	void tick()	 override;
+
+	size_t runUntil(size_t targetCycle) override;
+
+	void deserialize(StateReader& reader) override;
+
+private:
+	struct MicroOp {
+		uint16_t pc;		// Address of the opcode
+		uint16_t nextPc;	// Address of the following instruction
+		uint16_t operand;	// Resolved address, relative offset or base address
+		uint8_t opcode;
+		uint8_t cycles;
+	};
+
+	struct Block {
+		std::vector<MicroOp> ops;
+		size_t size = 0;	// In bytes of code
+	};
+
+	struct CodePage {
+		const uint8_t* memory = nullptr;
+		std::array<std::unique_ptr<Block>, 0x100> blocks;
+		// Number of blocks each byte of the page is part of
+		std::array<uint8_t, 0x100> coverage = {};
+	};
+
+	static const size_t pageSize = IBus<uint16_t, uint8_t>::directPageSize;
+	static const size_t pageCount = 0x10000 / pageSize;
+	static const size_t maxBlockLength = 32;
+	static const size_t maxBlockSize = maxBlockLength * 3;
+
+	void m_busWrite(uint16_t address, uint8_t data) override;
+
+	void m_executeInstruction();
+
+	// Addressing modes working from the pre-decoded operand
+	uint8_t m_IMP(const MicroOp& op);	uint8_t m_IMM(const MicroOp& op);
+	uint8_t m_ZP0(const MicroOp& op);	uint8_t m_ZPX(const MicroOp& op);
+	uint8_t m_ZPY(const MicroOp& op);	uint8_t m_REL(const MicroOp& op);
+	uint8_t m_ABS(const MicroOp& op);	uint8_t m_ABX(const MicroOp& op);
+	uint8_t m_ABY(const MicroOp& op);	uint8_t m_IND(const MicroOp& op);
+	uint8_t m_IZX(const MicroOp& op);	uint8_t m_IZY(const MicroOp& op);
+
+	Block* m_findBlock(uint16_t pc);
+	CodePage* m_mapCodePage(size_t pageIndex);
+	std::unique_ptr<Block> m_buildBlock(uint16_t pc, const CodePage& codePage);
+
+	void m_refreshDirectPages();
+	void m_invalidateMemory(const uint8_t* memory, size_t offset);
+	void m_dropBlock(CodePage& codePage, size_t offset);
+	void m_flush();
+
+private:
+	// Bus's direct pages and the copy the CPU reads and writes through
+	const DirectPage<uint16_t, uint8_t>* m_busPages = nullptr;
+	std::array<DirectPage<uint16_t, uint8_t>, pageCount> m_cpuPages;
+
+	// Every page decoded so far by (host memory, CPU page), and the
+	// ones that are currently mapped into the address space
+	std::map<std::pair<const uint8_t*, size_t>, std::unique_ptr<CodePage>> m_codePages;
+	std::array<CodePage*, pageCount> m_mappedCode = {};
+
+	// Host memory of writable pages holding blocks
+	std::set<const uint8_t*> m_ramCode;
+
+	// Block being executed and the index of its next micro-op
+	Block* m_block = nullptr;
+	size_t m_blockIndex = 0;
+};
+
+
+#define CPU_6502_CACHED_INSTANTIATE(instantiate)	\
+	instantiate(CPU_6502_Cached<>)					\
+	instantiate(CPU_6502_Cached<NesPageTableBus>)
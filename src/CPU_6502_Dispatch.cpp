@@ -0,0 +1,43 @@
+#include "CPU_6502.h"
+#include "NesPageTableBus.h"
+#include "Config.h"
+
+#ifdef CPU_SWITCH_DISPATCH
+
+//	+-----------------------+
+//	|	  Switch Dispatch		|
+//	+-----------------------+
+
+// Every opcode gets its own case with the addressing mode and the operation
+// called directly, so each instruction costs one jump through the switch's
+// table instead of two calls through member function pointers.
+#define OPCODE(code, operation, addressMode)				\
+	case code:												\
+		cycles = opcodeTable[code].cycles;					\
+		additionalCycles = addressMode();					\
+		additionalCycles &= operation();					\
+		break;
+
+template <typename busType>
+void CPU_6502<busType>::dispatchInstruction() {
+	uint8_t additionalCycles = 0;
+
+	switch (opcode) {
+#include "CPU_6502_OpcodeList.inl"
+	}
+
+	cycles += additionalCycles;
+}
+
+#undef OPCODE
+
+
+//	+-----------------------+
+//	|	  Instantiations		|
+//	+-----------------------+
+
+#define INSTANTIATE(cpu) template void cpu::dispatchInstruction();
+
+CPU_6502_INSTANTIATE(INSTANTIATE)
+
+#endif
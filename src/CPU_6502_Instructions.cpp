@@ -1,13 +1,15 @@
 #include <iostream>
 
 #include "CPU_6502.h"
+#include "NesPageTableBus.h"
 
 //	+-----------------------+
 //	|	  Instructions		|
 //	+-----------------------+
 
 // Add with Carry
-uint8_t CPU_6502::ADC() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ADC() {
 	fetchData();
 
 	result = (uint16_t)A + (uint16_t)fetchedData + (uint16_t)PS.CF;
@@ -23,7 +25,8 @@ uint8_t CPU_6502::ADC() {
 }
 
 // Logical AND
-uint8_t CPU_6502::AND() {
+template <typename busType>
+uint8_t CPU_6502<busType>::AND() {
 	fetchData();
 
 	A &= fetchedData;
@@ -35,7 +38,8 @@ uint8_t CPU_6502::AND() {
 }
 
 // Arithmetic Shift Left
-uint8_t CPU_6502::ASL() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ASL() {
 	fetchData();
 
 	result = (uint16_t)fetchedData << 1;
@@ -53,7 +57,8 @@ uint8_t CPU_6502::ASL() {
 }
 
 // Branch if Carry Clear
-uint8_t CPU_6502::BCC() {
+template <typename busType>
+uint8_t CPU_6502<busType>::BCC() {
 	if (PS.CF == 0) {
 		cycles++;
 		addressAbsolute = PC + addressRelative;
@@ -68,7 +73,8 @@ uint8_t CPU_6502::BCC() {
 }
 
 // Branch if Carry Set
-uint8_t CPU_6502::BCS() {
+template <typename busType>
+uint8_t CPU_6502<busType>::BCS() {
 	if (PS.CF == 1) {
 		cycles++;
 		addressAbsolute = PC + addressRelative;
@@ -83,7 +89,8 @@ uint8_t CPU_6502::BCS() {
 }
 
 // Branch if Equal
-uint8_t CPU_6502::BEQ() {
+template <typename busType>
+uint8_t CPU_6502<busType>::BEQ() {
 	if (PS.ZF == 1) {
 		cycles++;
 		addressAbsolute = PC + addressRelative;
@@ -98,7 +105,8 @@ uint8_t CPU_6502::BEQ() {
 }
 
 // Bit Test
-uint8_t CPU_6502::BIT() {
+template <typename busType>
+uint8_t CPU_6502<busType>::BIT() {
 	fetchData();
 
 	result = A & fetchedData;
@@ -111,7 +119,8 @@ uint8_t CPU_6502::BIT() {
 }
 
 // Branch if Minus
-uint8_t CPU_6502::BMI() {
+template <typename busType>
+uint8_t CPU_6502<busType>::BMI() {
 	if (PS.NF == 1) {
 		cycles++;
 		addressAbsolute = PC + addressRelative;
@@ -126,7 +135,8 @@ uint8_t CPU_6502::BMI() {
 }
 
 // Branch if Not Equal
-uint8_t CPU_6502::BNE() {
+template <typename busType>
+uint8_t CPU_6502<busType>::BNE() {
 	if (PS.ZF == 0) {
 		cycles++;
 		addressAbsolute = PC + addressRelative;
@@ -141,7 +151,8 @@ uint8_t CPU_6502::BNE() {
 }
 
 // Branch if Positive
-uint8_t CPU_6502::BPL() {
+template <typename busType>
+uint8_t CPU_6502<busType>::BPL() {
 	if (PS.NF == 0) {
 		cycles++;
 		addressAbsolute = PC + addressRelative;
@@ -156,7 +167,8 @@ uint8_t CPU_6502::BPL() {
 }
 
 // Force Interrupt
-uint8_t CPU_6502::BRK() {
+template <typename busType>
+uint8_t CPU_6502<busType>::BRK() {
 	PC++;
 	PS.ID = 1;
 
@@ -175,7 +187,8 @@ uint8_t CPU_6502::BRK() {
 }
 
 // Branch if Overflow Clear
-uint8_t CPU_6502::BVC() {
+template <typename busType>
+uint8_t CPU_6502<busType>::BVC() {
 	if (PS.OF == 0) {
 		cycles++;
 		addressAbsolute = PC + addressRelative;
@@ -191,7 +204,8 @@ uint8_t CPU_6502::BVC() {
 
 
 // Branch if Overflow Set
-uint8_t CPU_6502::BVS() {
+template <typename busType>
+uint8_t CPU_6502<busType>::BVS() {
 	if (PS.OF == 1) {
 		cycles++;
 		addressAbsolute = PC + addressRelative;
@@ -206,35 +220,40 @@ uint8_t CPU_6502::BVS() {
 }
 
 // Clear Carry Flag
-uint8_t CPU_6502::CLC() {
+template <typename busType>
+uint8_t CPU_6502<busType>::CLC() {
 	PS.CF = 0;
 
 	return 0;
 }
 
 // Clear Decimal Mode
-uint8_t CPU_6502::CLD() {
+template <typename busType>
+uint8_t CPU_6502<busType>::CLD() {
 	PS.DM = 0;
 
 	return 0;
 }
 
 // Clear Interrupt Disable
-uint8_t CPU_6502::CLI() {
+template <typename busType>
+uint8_t CPU_6502<busType>::CLI() {
 	PS.ID = 0;
 
 	return 0;
 }
 
 // Clear Overflow Flag
-uint8_t CPU_6502::CLV() {
+template <typename busType>
+uint8_t CPU_6502<busType>::CLV() {
 	PS.OF = 0;
 
 	return 0;
 }
 
 // Compare
-uint8_t CPU_6502::CMP() {
+template <typename busType>
+uint8_t CPU_6502<busType>::CMP() {
 	fetchData();
 
 	result = (uint16_t)A - (uint16_t)fetchedData;
@@ -247,7 +266,8 @@ uint8_t CPU_6502::CMP() {
 }
 
 // Compare X Register
-uint8_t CPU_6502::CPX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::CPX() {
 	fetchData();
 
 	result = (uint16_t)X - (uint16_t)fetchedData;
@@ -260,7 +280,8 @@ uint8_t CPU_6502::CPX() {
 }
 
 // Compare Y Register
-uint8_t CPU_6502::CPY() {
+template <typename busType>
+uint8_t CPU_6502<busType>::CPY() {
 	fetchData();
 
 	result = (uint16_t)Y - (uint16_t)fetchedData;
@@ -273,7 +294,8 @@ uint8_t CPU_6502::CPY() {
 }
 
 // Decrement Memory
-uint8_t CPU_6502::DEC() {
+template <typename busType>
+uint8_t CPU_6502<busType>::DEC() {
 	result = lowByte(readFrom(addressAbsolute) - 1);
 
 	writeTo(addressAbsolute, result);
@@ -285,7 +307,8 @@ uint8_t CPU_6502::DEC() {
 }
 
 // Decrement X Register
-uint8_t CPU_6502::DEX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::DEX() {
 	X--;
 
 	checkZF(X);
@@ -295,7 +318,8 @@ uint8_t CPU_6502::DEX() {
 }
 
 // Decrement Y Register
-uint8_t CPU_6502::DEY() {
+template <typename busType>
+uint8_t CPU_6502<busType>::DEY() {
 	Y--;
 
 	checkZF(Y);
@@ -305,7 +329,8 @@ uint8_t CPU_6502::DEY() {
 }
 
 // Exclusive OR
-uint8_t CPU_6502::EOR() {
+template <typename busType>
+uint8_t CPU_6502<busType>::EOR() {
 	fetchData();
 
 	A ^= fetchedData;
@@ -317,7 +342,8 @@ uint8_t CPU_6502::EOR() {
 }
 
 // Increment Memory
-uint8_t CPU_6502::INC() {
+template <typename busType>
+uint8_t CPU_6502<busType>::INC() {
 	if (isIMP()) {
 		A++;
 
@@ -337,7 +363,8 @@ uint8_t CPU_6502::INC() {
 }
 
 // Increment X Register
-uint8_t CPU_6502::INX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::INX() {
 	X++;
 
 	checkZF(X);
@@ -347,7 +374,8 @@ uint8_t CPU_6502::INX() {
 }
 
 // Increment Y Register
-uint8_t CPU_6502::INY() {
+template <typename busType>
+uint8_t CPU_6502<busType>::INY() {
 	Y++;
 
 	checkZF(Y);
@@ -357,14 +385,16 @@ uint8_t CPU_6502::INY() {
 }
 
 // Jump
-uint8_t CPU_6502::JMP() {
+template <typename busType>
+uint8_t CPU_6502<busType>::JMP() {
 	PC = addressAbsolute;
 
 	return 0;
 }
 
 // Jump to Subroutine
-uint8_t CPU_6502::JSR() {
+template <typename busType>
+uint8_t CPU_6502<busType>::JSR() {
 	result = PC - 1;
 
 	push(highByte(result));
@@ -376,7 +406,8 @@ uint8_t CPU_6502::JSR() {
 }
 
 // Load Accumulator
-uint8_t CPU_6502::LDA() {
+template <typename busType>
+uint8_t CPU_6502<busType>::LDA() {
 	fetchData();
 
 	A = fetchedData;
@@ -388,7 +419,8 @@ uint8_t CPU_6502::LDA() {
 }
 
 // Load X Register
-uint8_t CPU_6502::LDX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::LDX() {
 	fetchData();
 
 	X = fetchedData;
@@ -400,7 +432,8 @@ uint8_t CPU_6502::LDX() {
 }
 
 // Load Y Register
-uint8_t CPU_6502::LDY() {
+template <typename busType>
+uint8_t CPU_6502<busType>::LDY() {
 	fetchData();
 
 	Y = fetchedData;
@@ -412,7 +445,8 @@ uint8_t CPU_6502::LDY() {
 }
 
 // Logical Shift Right
-uint8_t CPU_6502::LSR() {
+template <typename busType>
+uint8_t CPU_6502<busType>::LSR() {
 	fetchData();
 
 	PS.CF = fetchedData & 0x0001;
@@ -431,7 +465,8 @@ uint8_t CPU_6502::LSR() {
 }
 
 // No Operation
-uint8_t CPU_6502::NOP() {
+template <typename busType>
+uint8_t CPU_6502<busType>::NOP() {
 	// Multiple NOPs, check which one
 	// https://wiki.nesdev.com/w/index.php/CPU_unofficial_opcodes
 
@@ -451,7 +486,8 @@ uint8_t CPU_6502::NOP() {
 }
 
 // Logical Inclusive OR
-uint8_t CPU_6502::ORA() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ORA() {
 	fetchData();
 
 	A |= fetchedData;
@@ -463,14 +499,16 @@ uint8_t CPU_6502::ORA() {
 }
 
 // Push Accumulator
-uint8_t CPU_6502::PHA() {
+template <typename busType>
+uint8_t CPU_6502<busType>::PHA() {
 	push(A);
 
 	return 0;
 }
 
 // Push Processor Status
-uint8_t CPU_6502::PHP() {
+template <typename busType>
+uint8_t CPU_6502<busType>::PHP() {
 	PS.BC = 1;
 	PS.XX = 1;
 	push(PS.data);
@@ -482,7 +520,8 @@ uint8_t CPU_6502::PHP() {
 }
 
 // Pull Accumulator
-uint8_t CPU_6502::PLA() {
+template <typename busType>
+uint8_t CPU_6502<busType>::PLA() {
 	A = pull();
 
 	checkZF(A);
@@ -492,7 +531,8 @@ uint8_t CPU_6502::PLA() {
 }
 
 // Pull Processor Status
-uint8_t CPU_6502::PLP() {
+template <typename busType>
+uint8_t CPU_6502<busType>::PLP() {
 	PS.data = pull();
 
 	PS.XX = 1;
@@ -503,7 +543,8 @@ uint8_t CPU_6502::PLP() {
 }
 
 // Rotate Left
-uint8_t CPU_6502::ROL() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ROL() {
 	fetchData();
 
 	result = (uint16_t)(fetchedData << 1) | PS.CF;
@@ -521,7 +562,8 @@ uint8_t CPU_6502::ROL() {
 }
 
 // Rotate Right
-uint8_t CPU_6502::ROR() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ROR() {
 	fetchData();
 
 	result = (uint16_t)(PS.CF << 7) | (fetchedData >> 1);
@@ -539,7 +581,8 @@ uint8_t CPU_6502::ROR() {
 }
 
 // Return from Interrupt
-uint8_t CPU_6502::RTI() {
+template <typename busType>
+uint8_t CPU_6502<busType>::RTI() {
 	PS.data = pull();
 	// PS.data &= ~PS.BC
 	// PS.data &= ~PS.XX
@@ -551,7 +594,8 @@ uint8_t CPU_6502::RTI() {
 }
 
 // Return from Subroutine
-uint8_t CPU_6502::RTS() {
+template <typename busType>
+uint8_t CPU_6502<busType>::RTS() {
 	PC = (uint16_t)pull();
 	PC |= (uint16_t)pull() << 8;
 
@@ -561,7 +605,8 @@ uint8_t CPU_6502::RTS() {
 }
 
 // Subtract with Carry
-uint8_t CPU_6502::SBC() {
+template <typename busType>
+uint8_t CPU_6502<busType>::SBC() {
 	fetchData();
 
 	result = (uint16_t)A + ((uint16_t)fetchedData ^ 0x00FF) + (uint16_t)PS.CF;
@@ -577,49 +622,56 @@ uint8_t CPU_6502::SBC() {
 }
 
 // Set Carry Flag
-uint8_t CPU_6502::SEC() {
+template <typename busType>
+uint8_t CPU_6502<busType>::SEC() {
 	PS.CF = 1;
 
 	return 0;
 }
 
 // Set Decimal Flag
-uint8_t CPU_6502::SED() {
+template <typename busType>
+uint8_t CPU_6502<busType>::SED() {
 	PS.DM = 1;
 
 	return 0;
 }
 
 // Set Interrupt Disable
-uint8_t CPU_6502::SEI() {
+template <typename busType>
+uint8_t CPU_6502<busType>::SEI() {
 	PS.ID = 1;
 
 	return 0;
 }
 
 // Store Accumulator
-uint8_t CPU_6502::STA() {
+template <typename busType>
+uint8_t CPU_6502<busType>::STA() {
 	writeTo(addressAbsolute, A);
 
 	return 0;
 }
 
 // Store X Register
-uint8_t CPU_6502::STX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::STX() {
 	writeTo(addressAbsolute, X);
 
 	return 0;
 }
 
 // Store Y Register
-uint8_t CPU_6502::STY() {
+template <typename busType>
+uint8_t CPU_6502<busType>::STY() {
 	writeTo(addressAbsolute, Y);
 
 	return 0;
 }
 
 // Transfer Accumulator to X
-uint8_t CPU_6502::TAX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::TAX() {
 	X = A;
 
 	checkZF(X);
@@ -629,7 +681,8 @@ uint8_t CPU_6502::TAX() {
 }
 
 // Transfer Accumulator to Y
-uint8_t CPU_6502::TAY() {
+template <typename busType>
+uint8_t CPU_6502<busType>::TAY() {
 	Y = A;
 
 	checkZF(Y);
@@ -639,7 +692,8 @@ uint8_t CPU_6502::TAY() {
 }
 
 // Transfer Stack Pointer to X
-uint8_t CPU_6502::TSX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::TSX() {
 	X = SP;
 
 	checkZF(X);
@@ -649,7 +703,8 @@ uint8_t CPU_6502::TSX() {
 }
 
 // Transfer X to Accumulator
-uint8_t CPU_6502::TXA() {
+template <typename busType>
+uint8_t CPU_6502<busType>::TXA() {
 	A = X;
 
 	checkZF(A);
@@ -660,14 +715,16 @@ uint8_t CPU_6502::TXA() {
 
 
 // Transfer A to Stack Pointer
-uint8_t CPU_6502::TXS() {
+template <typename busType>
+uint8_t CPU_6502<busType>::TXS() {
 	SP = X;
 
 	return 0;
 }
 
 // Transfer Y to Accumulator
-uint8_t CPU_6502::TYA() {
+template <typename busType>
+uint8_t CPU_6502<busType>::TYA() {
 	A = Y;
 
 	checkZF(A);
@@ -683,7 +740,8 @@ uint8_t CPU_6502::TYA() {
 
 
 // Load Accumulator and X Register
-uint8_t CPU_6502::LAX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::LAX() {
 	fetchData();
 
 	A = fetchedData;
@@ -696,14 +754,16 @@ uint8_t CPU_6502::LAX() {
 }
 
 // Store Accumulator AND X Register
-uint8_t CPU_6502::SAX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::SAX() {
 	writeTo(addressAbsolute, A & X);
 
 	return 0;
 }
 
 // Decrement Memory and Accumulator
-uint8_t CPU_6502::DCP() {
+template <typename busType>
+uint8_t CPU_6502<busType>::DCP() {
 	result = lowByte(readFrom(addressAbsolute) - 1);
 
 	writeTo(addressAbsolute, result);
@@ -718,7 +778,8 @@ uint8_t CPU_6502::DCP() {
 }
 
 // Increment Memory and Subtract Memory from Accumulator
-uint8_t CPU_6502::ISB() {
+template <typename busType>
+uint8_t CPU_6502<busType>::ISB() {
 	result = lowByte(readFrom(addressAbsolute) + 1);
 
 	writeTo(addressAbsolute, result);
@@ -736,7 +797,8 @@ uint8_t CPU_6502::ISB() {
 }
 
 // Shift Left and OR Accumulator with Memory
-uint8_t CPU_6502::SLO() {
+template <typename busType>
+uint8_t CPU_6502<busType>::SLO() {
 	fetchData();
 
 	result = (uint16_t)fetchedData << 1;
@@ -752,7 +814,8 @@ uint8_t CPU_6502::SLO() {
 }
 
 // Rotate Left and AND Accumulator with Memory
-uint8_t CPU_6502::RLA() {
+template <typename busType>
+uint8_t CPU_6502<busType>::RLA() {
 	fetchData();
 
 	result = ((uint16_t)fetchedData << 1) + (uint16_t)PS.CF;
@@ -768,7 +831,8 @@ uint8_t CPU_6502::RLA() {
 }
 
 // Shift Right and XOR Accumulator with Memory
-uint8_t CPU_6502::SRE() {
+template <typename busType>
+uint8_t CPU_6502<busType>::SRE() {
 	fetchData();
 
 	result = fetchedData >> 1;
@@ -784,7 +848,8 @@ uint8_t CPU_6502::SRE() {
 }
 
 // Rotate Right and ADC Accumulator with Memory
-uint8_t CPU_6502::RRA() {
+template <typename busType>
+uint8_t CPU_6502<busType>::RRA() {
 	fetchData();
 
 	addressRelative = (fetchedData >> 1) ^ (PS.CF << 7);
@@ -805,7 +870,8 @@ uint8_t CPU_6502::RRA() {
 }
 
 // Unknown Instructions
-uint8_t CPU_6502::XXX() {
+template <typename busType>
+uint8_t CPU_6502<busType>::XXX() {
 	if (opcode == 0x32) {
 		fmt::print(" JAM instruction");
 		std::cin.get();
@@ -817,3 +883,29 @@ uint8_t CPU_6502::XXX() {
 
 	return 0;
 }
+
+
+//	+-----------------------+
+//	|	  Instantiations		|
+//	+-----------------------+
+
+#define INSTANTIATE(cpu) \
+	template uint8_t cpu::ADC(); template uint8_t cpu::AND(); template uint8_t cpu::ASL(); template uint8_t cpu::BCC(); \
+	template uint8_t cpu::BCS(); template uint8_t cpu::BEQ(); template uint8_t cpu::BIT(); template uint8_t cpu::BMI(); \
+	template uint8_t cpu::BNE(); template uint8_t cpu::BPL(); template uint8_t cpu::BRK(); template uint8_t cpu::BVC(); \
+	template uint8_t cpu::BVS(); template uint8_t cpu::CLC(); template uint8_t cpu::CLD(); template uint8_t cpu::CLI(); \
+	template uint8_t cpu::CLV(); template uint8_t cpu::CMP(); template uint8_t cpu::CPX(); template uint8_t cpu::CPY(); \
+	template uint8_t cpu::DEC(); template uint8_t cpu::DEX(); template uint8_t cpu::DEY(); template uint8_t cpu::EOR(); \
+	template uint8_t cpu::INC(); template uint8_t cpu::INX(); template uint8_t cpu::INY(); template uint8_t cpu::JMP(); \
+	template uint8_t cpu::JSR(); template uint8_t cpu::LDA(); template uint8_t cpu::LDX(); template uint8_t cpu::LDY(); \
+	template uint8_t cpu::LSR(); template uint8_t cpu::NOP(); template uint8_t cpu::ORA(); template uint8_t cpu::PHA(); \
+	template uint8_t cpu::PHP(); template uint8_t cpu::PLA(); template uint8_t cpu::PLP(); template uint8_t cpu::ROL(); \
+	template uint8_t cpu::ROR(); template uint8_t cpu::RTI(); template uint8_t cpu::RTS(); template uint8_t cpu::SBC(); \
+	template uint8_t cpu::SEC(); template uint8_t cpu::SED(); template uint8_t cpu::SEI(); template uint8_t cpu::STA(); \
+	template uint8_t cpu::STX(); template uint8_t cpu::STY(); template uint8_t cpu::TAX(); template uint8_t cpu::TAY(); \
+	template uint8_t cpu::TSX(); template uint8_t cpu::TXA(); template uint8_t cpu::TXS(); template uint8_t cpu::TYA(); \
+	template uint8_t cpu::LAX(); template uint8_t cpu::SAX(); template uint8_t cpu::DCP(); template uint8_t cpu::ISB(); \
+	template uint8_t cpu::SLO(); template uint8_t cpu::RLA(); template uint8_t cpu::SRE(); template uint8_t cpu::RRA(); \
+	template uint8_t cpu::XXX();
+
+CPU_6502_INSTANTIATE(INSTANTIATE)
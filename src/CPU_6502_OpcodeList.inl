@@ -0,0 +1,291 @@
+// Every opcode with the operation and addressing mode it runs, include
+// it with OPCODE(code, operation, addressMode) defined to generate code
+// for all 256 of them. Kept in one place so the dispatchers can't drift.
+
+// 0x
+OPCODE(0x00, BRK, IMM)
+OPCODE(0x01, ORA, IZX)
+OPCODE(0x02, XXX, IMP)
+OPCODE(0x03, SLO, IZX)
+OPCODE(0x04, NOP, ZP0)
+OPCODE(0x05, ORA, ZP0)
+OPCODE(0x06, ASL, ZP0)
+OPCODE(0x07, SLO, ZP0)
+OPCODE(0x08, PHP, IMP)
+OPCODE(0x09, ORA, IMM)
+OPCODE(0x0A, ASL, IMP)
+OPCODE(0x0B, XXX, IMP)
+OPCODE(0x0C, NOP, ABS)
+OPCODE(0x0D, ORA, ABS)
+OPCODE(0x0E, ASL, ABS)
+OPCODE(0x0F, SLO, ABS)
+
+// 1x
+OPCODE(0x10, BPL, REL)
+OPCODE(0x11, ORA, IZY)
+OPCODE(0x12, XXX, IMP)
+OPCODE(0x13, SLO, IZY)
+OPCODE(0x14, NOP, ZPX)
+OPCODE(0x15, ORA, ZPX)
+OPCODE(0x16, ASL, ZPX)
+OPCODE(0x17, SLO, ZPX)
+OPCODE(0x18, CLC, IMP)
+OPCODE(0x19, ORA, ABY)
+OPCODE(0x1A, NOP, IMP)
+OPCODE(0x1B, SLO, ABY)
+OPCODE(0x1C, NOP, ABX)
+OPCODE(0x1D, ORA, ABX)
+OPCODE(0x1E, ASL, ABX)
+OPCODE(0x1F, SLO, ABX)
+
+// 2x
+OPCODE(0x20, JSR, ABS)
+OPCODE(0x21, AND, IZX)
+OPCODE(0x22, XXX, IMP)
+OPCODE(0x23, RLA, IZX)
+OPCODE(0x24, BIT, ZP0)
+OPCODE(0x25, AND, ZP0)
+OPCODE(0x26, ROL, ZP0)
+OPCODE(0x27, RLA, ZP0)
+OPCODE(0x28, PLP, IMP)
+OPCODE(0x29, AND, IMM)
+OPCODE(0x2A, ROL, IMP)
+OPCODE(0x2B, XXX, IMP)
+OPCODE(0x2C, BIT, ABS)
+OPCODE(0x2D, AND, ABS)
+OPCODE(0x2E, ROL, ABS)
+OPCODE(0x2F, RLA, ABS)
+
+// 3x
+OPCODE(0x30, BMI, REL)
+OPCODE(0x31, AND, IZY)
+OPCODE(0x32, XXX, IMP)
+OPCODE(0x33, RLA, IZY)
+OPCODE(0x34, NOP, ZPX)
+OPCODE(0x35, AND, ZPX)
+OPCODE(0x36, ROL, ZPX)
+OPCODE(0x37, RLA, ZPX)
+OPCODE(0x38, SEC, IMP)
+OPCODE(0x39, AND, ABY)
+OPCODE(0x3A, NOP, IMP)
+OPCODE(0x3B, RLA, ABY)
+OPCODE(0x3C, NOP, ABX)
+OPCODE(0x3D, AND, ABX)
+OPCODE(0x3E, ROL, ABX)
+OPCODE(0x3F, RLA, ABX)
+
+// 4x
+OPCODE(0x40, RTI, IMP)
+OPCODE(0x41, EOR, IZX)
+OPCODE(0x42, XXX, IMP)
+OPCODE(0x43, SRE, IZX)
+OPCODE(0x44, NOP, ZP0)
+OPCODE(0x45, EOR, ZP0)
+OPCODE(0x46, LSR, ZP0)
+OPCODE(0x47, SRE, ZP0)
+OPCODE(0x48, PHA, IMP)
+OPCODE(0x49, EOR, IMM)
+OPCODE(0x4A, LSR, IMP)
+OPCODE(0x4B, XXX, IMP)
+OPCODE(0x4C, JMP, ABS)
+OPCODE(0x4D, EOR, ABS)
+OPCODE(0x4E, LSR, ABS)
+OPCODE(0x4F, SRE, ABS)
+
+// 5x
+OPCODE(0x50, BVC, REL)
+OPCODE(0x51, EOR, IZY)
+OPCODE(0x52, XXX, IMP)
+OPCODE(0x53, SRE, IZY)
+OPCODE(0x54, NOP, ZPX)
+OPCODE(0x55, EOR, ZPX)
+OPCODE(0x56, LSR, ZPX)
+OPCODE(0x57, SRE, ZPX)
+OPCODE(0x58, CLI, IMP)
+OPCODE(0x59, EOR, ABY)
+OPCODE(0x5A, NOP, IMP)
+OPCODE(0x5B, SRE, ABY)
+OPCODE(0x5C, NOP, ABX)
+OPCODE(0x5D, EOR, ABX)
+OPCODE(0x5E, LSR, ABX)
+OPCODE(0x5F, SRE, ABX)
+
+// 6x
+OPCODE(0x60, RTS, IMP)
+OPCODE(0x61, ADC, IZX)
+OPCODE(0x62, XXX, IMP)
+OPCODE(0x63, RRA, IZX)
+OPCODE(0x64, NOP, ZP0)
+OPCODE(0x65, ADC, ZP0)
+OPCODE(0x66, ROR, ZP0)
+OPCODE(0x67, RRA, ZP0)
+OPCODE(0x68, PLA, IMP)
+OPCODE(0x69, ADC, IMM)
+OPCODE(0x6A, ROR, IMP)
+OPCODE(0x6B, XXX, IMP)
+OPCODE(0x6C, JMP, IND)
+OPCODE(0x6D, ADC, ABS)
+OPCODE(0x6E, ROR, ABS)
+OPCODE(0x6F, RRA, ABS)
+
+// 7x
+OPCODE(0x70, BVS, REL)
+OPCODE(0x71, ADC, IZY)
+OPCODE(0x72, XXX, IMP)
+OPCODE(0x73, RRA, IZY)
+OPCODE(0x74, NOP, ZPX)
+OPCODE(0x75, ADC, ZPX)
+OPCODE(0x76, ROR, ZPX)
+OPCODE(0x77, RRA, ZPX)
+OPCODE(0x78, SEI, IMP)
+OPCODE(0x79, ADC, ABY)
+OPCODE(0x7A, NOP, IMP)
+OPCODE(0x7B, RRA, ABY)
+OPCODE(0x7C, NOP, ABX)
+OPCODE(0x7D, ADC, ABX)
+OPCODE(0x7E, ROR, ABX)
+OPCODE(0x7F, RRA, ABX)
+
+// 8x
+OPCODE(0x80, NOP, IMM)
+OPCODE(0x81, STA, IZX)
+OPCODE(0x82, NOP, IMP)
+OPCODE(0x83, SAX, IZX)
+OPCODE(0x84, STY, ZP0)
+OPCODE(0x85, STA, ZP0)
+OPCODE(0x86, STX, ZP0)
+OPCODE(0x87, SAX, ZP0)
+OPCODE(0x88, DEY, IMP)
+OPCODE(0x89, NOP, IMP)
+OPCODE(0x8A, TXA, IMP)
+OPCODE(0x8B, XXX, IMP)
+OPCODE(0x8C, STY, ABS)
+OPCODE(0x8D, STA, ABS)
+OPCODE(0x8E, STX, ABS)
+OPCODE(0x8F, SAX, ABS)
+
+// 9x
+OPCODE(0x90, BCC, REL)
+OPCODE(0x91, STA, IZY)
+OPCODE(0x92, XXX, IMP)
+OPCODE(0x93, XXX, IMP)
+OPCODE(0x94, STY, ZPX)
+OPCODE(0x95, STA, ZPX)
+OPCODE(0x96, STX, ZPY)
+OPCODE(0x97, SAX, ZPY)
+OPCODE(0x98, TYA, IMP)
+OPCODE(0x99, STA, ABY)
+OPCODE(0x9A, TXS, IMP)
+OPCODE(0x9B, XXX, IMP)
+OPCODE(0x9C, NOP, ABX)
+OPCODE(0x9D, STA, ABX)
+OPCODE(0x9E, XXX, IMP)
+OPCODE(0x9F, XXX, IMP)
+
+// Ax
+OPCODE(0xA0, LDY, IMM)
+OPCODE(0xA1, LDA, IZX)
+OPCODE(0xA2, LDX, IMM)
+OPCODE(0xA3, LAX, IZX)
+OPCODE(0xA4, LDY, ZP0)
+OPCODE(0xA5, LDA, ZP0)
+OPCODE(0xA6, LDX, ZP0)
+OPCODE(0xA7, LAX, ZP0)
+OPCODE(0xA8, TAY, IMP)
+OPCODE(0xA9, LDA, IMM)
+OPCODE(0xAA, TAX, IMP)
+OPCODE(0xAB, XXX, IMP)
+OPCODE(0xAC, LDY, ABS)
+OPCODE(0xAD, LDA, ABS)
+OPCODE(0xAE, LDX, ABS)
+OPCODE(0xAF, LAX, ABS)
+
+// Bx
+OPCODE(0xB0, BCS, REL)
+OPCODE(0xB1, LDA, IZY)
+OPCODE(0xB2, XXX, IMP)
+OPCODE(0xB3, LAX, IZY)
+OPCODE(0xB4, LDY, ZPX)
+OPCODE(0xB5, LDA, ZPX)
+OPCODE(0xB6, LDX, ZPY)
+OPCODE(0xB7, LAX, ZPY)
+OPCODE(0xB8, CLV, IMP)
+OPCODE(0xB9, LDA, ABY)
+OPCODE(0xBA, TSX, IMP)
+OPCODE(0xBB, XXX, IMP)
+OPCODE(0xBC, LDY, ABX)
+OPCODE(0xBD, LDA, ABX)
+OPCODE(0xBE, LDX, ABY)
+OPCODE(0xBF, LAX, ABY)
+
+// Cx
+OPCODE(0xC0, CPY, IMM)
+OPCODE(0xC1, CMP, IZX)
+OPCODE(0xC2, NOP, IMP)
+OPCODE(0xC3, DCP, IZX)
+OPCODE(0xC4, CPY, ZP0)
+OPCODE(0xC5, CMP, ZP0)
+OPCODE(0xC6, DEC, ZP0)
+OPCODE(0xC7, DCP, ZP0)
+OPCODE(0xC8, INY, IMP)
+OPCODE(0xC9, CMP, IMM)
+OPCODE(0xCA, DEX, IMP)
+OPCODE(0xCB, XXX, IMP)
+OPCODE(0xCC, CPY, ABS)
+OPCODE(0xCD, CMP, ABS)
+OPCODE(0xCE, DEC, ABS)
+OPCODE(0xCF, DCP, ABS)
+
+// Dx
+OPCODE(0xD0, BNE, REL)
+OPCODE(0xD1, CMP, IZY)
+OPCODE(0xD2, XXX, IMP)
+OPCODE(0xD3, DCP, IZY)
+OPCODE(0xD4, NOP, ZPX)
+OPCODE(0xD5, CMP, ZPX)
+OPCODE(0xD6, DEC, ZPX)
+OPCODE(0xD7, DCP, ZPX)
+OPCODE(0xD8, CLD, IMP)
+OPCODE(0xD9, CMP, ABY)
+OPCODE(0xDA, NOP, IMP)
+OPCODE(0xDB, DCP, ABY)
+OPCODE(0xDC, NOP, ABX)
+OPCODE(0xDD, CMP, ABX)
+OPCODE(0xDE, DEC, ABX)
+OPCODE(0xDF, DCP, ABX)
+
+// Ex
+OPCODE(0xE0, CPX, IMM)
+OPCODE(0xE1, SBC, IZX)
+OPCODE(0xE2, NOP, IMP)
+OPCODE(0xE3, ISB, IZX)
+OPCODE(0xE4, CPX, ZP0)
+OPCODE(0xE5, SBC, ZP0)
+OPCODE(0xE6, INC, ZP0)
+OPCODE(0xE7, ISB, ZP0)
+OPCODE(0xE8, INX, IMP)
+OPCODE(0xE9, SBC, IMM)
+OPCODE(0xEA, NOP, IMP)
+OPCODE(0xEB, SBC, IMM)
+OPCODE(0xEC, CPX, ABS)
+OPCODE(0xED, SBC, ABS)
+OPCODE(0xEE, INC, ABS)
+OPCODE(0xEF, ISB, ABS)
+
+// Fx
+OPCODE(0xF0, BEQ, REL)
+OPCODE(0xF1, SBC, IZY)
+OPCODE(0xF2, XXX, IMP)
+OPCODE(0xF3, ISB, IZY)
+OPCODE(0xF4, NOP, ZPX)
+OPCODE(0xF5, SBC, ZPX)
+OPCODE(0xF6, INC, ZPX)
+OPCODE(0xF7, ISB, ZPX)
+OPCODE(0xF8, SED, IMP)
+OPCODE(0xF9, SBC, ABY)
+OPCODE(0xFA, NOP, IMP)
+OPCODE(0xFB, ISB, ABY)
+OPCODE(0xFC, NOP, ABX)
+OPCODE(0xFD, SBC, ABX)
+OPCODE(0xFE, INC, ABX)
+OPCODE(0xFF, ISB, ABX)
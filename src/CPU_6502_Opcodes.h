@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+
+enum class ADDRESS_MODE : uint8_t {
+	IMP, IMM, ZP0,
+	ZPX, ZPY, REL,
+	ABS, ABX, ABY,
+	IND, IZX, IZY
+};
+
+
+// Static description of an opcode, plain data so the whole
+// table is built at compile time and never touches the heap
+struct OpcodeInfo {
+	char		 name[4];		//	Mnemonic, only read when tracing
+	ADDRESS_MODE addressMode;	//	Addressing Mode
+	uint8_t		 cycles;		//	Base Cycle Count
+	bool		 illegal;		//	Unofficial Opcode
+};
+
+
+//	+-----------------------+
+//	|	  Opcode Table		|
+//	+-----------------------+
+
+inline constexpr std::array<OpcodeInfo, 256> opcodeTable = {{
+//			|                  x0                  |                  x1                  |                  x2                  |                  x3                  |                  x4                  |                  x5                  |                  x6                  |                  x7                  |                  x8                  |                  x9                  |                  xA                  |                  xB                  |                  xC                  |                  xD                  |                  xE                  |                  xF                  |
+/*  0x  */	{ "BRK", ADDRESS_MODE::IMM, 7, false },{ "ORA", ADDRESS_MODE::IZX, 6, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "SLO", ADDRESS_MODE::IZX, 8, true  },{ "NOP", ADDRESS_MODE::ZP0, 3, true  },{ "ORA", ADDRESS_MODE::ZP0, 3, false },{ "ASL", ADDRESS_MODE::ZP0, 5, false },{ "SLO", ADDRESS_MODE::ZP0, 5, true  },{ "PHP", ADDRESS_MODE::IMP, 3, false },{ "ORA", ADDRESS_MODE::IMM, 2, false },{ "ASL", ADDRESS_MODE::IMP, 2, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "NOP", ADDRESS_MODE::ABS, 4, true  },{ "ORA", ADDRESS_MODE::ABS, 4, false },{ "ASL", ADDRESS_MODE::ABS, 6, false },{ "SLO", ADDRESS_MODE::ABS, 6, true  },
+/*  1x  */	{ "BPL", ADDRESS_MODE::REL, 2, false },{ "ORA", ADDRESS_MODE::IZY, 5, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "SLO", ADDRESS_MODE::IZY, 8, true  },{ "NOP", ADDRESS_MODE::ZPX, 4, true  },{ "ORA", ADDRESS_MODE::ZPX, 4, false },{ "ASL", ADDRESS_MODE::ZPX, 6, false },{ "SLO", ADDRESS_MODE::ZPX, 6, true  },{ "CLC", ADDRESS_MODE::IMP, 2, false },{ "ORA", ADDRESS_MODE::ABY, 4, false },{ "NOP", ADDRESS_MODE::IMP, 2, true  },{ "SLO", ADDRESS_MODE::ABY, 7, true  },{ "NOP", ADDRESS_MODE::ABX, 4, true  },{ "ORA", ADDRESS_MODE::ABX, 4, false },{ "ASL", ADDRESS_MODE::ABX, 7, false },{ "SLO", ADDRESS_MODE::ABX, 7, true  },
+/*  2x  */	{ "JSR", ADDRESS_MODE::ABS, 6, false },{ "AND", ADDRESS_MODE::IZX, 6, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "RLA", ADDRESS_MODE::IZX, 8, true  },{ "BIT", ADDRESS_MODE::ZP0, 3, false },{ "AND", ADDRESS_MODE::ZP0, 3, false },{ "ROL", ADDRESS_MODE::ZP0, 5, false },{ "RLA", ADDRESS_MODE::ZP0, 5, true  },{ "PLP", ADDRESS_MODE::IMP, 4, false },{ "AND", ADDRESS_MODE::IMM, 2, false },{ "ROL", ADDRESS_MODE::IMP, 2, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "BIT", ADDRESS_MODE::ABS, 4, false },{ "AND", ADDRESS_MODE::ABS, 4, false },{ "ROL", ADDRESS_MODE::ABS, 6, false },{ "RLA", ADDRESS_MODE::ABS, 6, true  },
+/*  3x  */	{ "BMI", ADDRESS_MODE::REL, 2, false },{ "AND", ADDRESS_MODE::IZY, 5, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "RLA", ADDRESS_MODE::IZY, 8, true  },{ "NOP", ADDRESS_MODE::ZPX, 4, true  },{ "AND", ADDRESS_MODE::ZPX, 4, false },{ "ROL", ADDRESS_MODE::ZPX, 6, false },{ "RLA", ADDRESS_MODE::ZPX, 6, true  },{ "SEC", ADDRESS_MODE::IMP, 2, false },{ "AND", ADDRESS_MODE::ABY, 4, false },{ "NOP", ADDRESS_MODE::IMP, 2, true  },{ "RLA", ADDRESS_MODE::ABY, 7, true  },{ "NOP", ADDRESS_MODE::ABX, 4, true  },{ "AND", ADDRESS_MODE::ABX, 4, false },{ "ROL", ADDRESS_MODE::ABX, 7, false },{ "RLA", ADDRESS_MODE::ABX, 7, true  },
+/*  4x  */	{ "RTI", ADDRESS_MODE::IMP, 6, false },{ "EOR", ADDRESS_MODE::IZX, 6, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "SRE", ADDRESS_MODE::IZX, 8, true  },{ "NOP", ADDRESS_MODE::ZP0, 3, true  },{ "EOR", ADDRESS_MODE::ZP0, 3, false },{ "LSR", ADDRESS_MODE::ZP0, 5, false },{ "SRE", ADDRESS_MODE::ZP0, 5, true  },{ "PHA", ADDRESS_MODE::IMP, 3, false },{ "EOR", ADDRESS_MODE::IMM, 2, false },{ "LSR", ADDRESS_MODE::IMP, 2, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "JMP", ADDRESS_MODE::ABS, 3, false },{ "EOR", ADDRESS_MODE::ABS, 4, false },{ "LSR", ADDRESS_MODE::ABS, 6, false },{ "SRE", ADDRESS_MODE::ABS, 6, true  },
+/*  5x  */	{ "BVC", ADDRESS_MODE::REL, 2, false },{ "EOR", ADDRESS_MODE::IZY, 5, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "SRE", ADDRESS_MODE::IZY, 8, true  },{ "NOP", ADDRESS_MODE::ZPX, 4, true  },{ "EOR", ADDRESS_MODE::ZPX, 4, false },{ "LSR", ADDRESS_MODE::ZPX, 6, false },{ "SRE", ADDRESS_MODE::ZPX, 6, true  },{ "CLI", ADDRESS_MODE::IMP, 2, false },{ "EOR", ADDRESS_MODE::ABY, 4, false },{ "NOP", ADDRESS_MODE::IMP, 2, true  },{ "SRE", ADDRESS_MODE::ABY, 7, true  },{ "NOP", ADDRESS_MODE::ABX, 4, true  },{ "EOR", ADDRESS_MODE::ABX, 4, false },{ "LSR", ADDRESS_MODE::ABX, 7, false },{ "SRE", ADDRESS_MODE::ABX, 7, true  },
+/*  6x  */	{ "RTS", ADDRESS_MODE::IMP, 6, false },{ "ADC", ADDRESS_MODE::IZX, 6, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "RRA", ADDRESS_MODE::IZX, 8, true  },{ "NOP", ADDRESS_MODE::ZP0, 3, true  },{ "ADC", ADDRESS_MODE::ZP0, 3, false },{ "ROR", ADDRESS_MODE::ZP0, 5, false },{ "RRA", ADDRESS_MODE::ZP0, 5, true  },{ "PLA", ADDRESS_MODE::IMP, 4, false },{ "ADC", ADDRESS_MODE::IMM, 2, false },{ "ROR", ADDRESS_MODE::IMP, 2, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "JMP", ADDRESS_MODE::IND, 5, false },{ "ADC", ADDRESS_MODE::ABS, 4, false },{ "ROR", ADDRESS_MODE::ABS, 6, false },{ "RRA", ADDRESS_MODE::ABS, 6, true  },
+/*  7x  */	{ "BVS", ADDRESS_MODE::REL, 2, false },{ "ADC", ADDRESS_MODE::IZY, 5, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "RRA", ADDRESS_MODE::IZY, 8, true  },{ "NOP", ADDRESS_MODE::ZPX, 4, true  },{ "ADC", ADDRESS_MODE::ZPX, 4, false },{ "ROR", ADDRESS_MODE::ZPX, 6, false },{ "RRA", ADDRESS_MODE::ZPX, 6, true  },{ "SEI", ADDRESS_MODE::IMP, 2, false },{ "ADC", ADDRESS_MODE::ABY, 4, false },{ "NOP", ADDRESS_MODE::IMP, 2, true  },{ "RRA", ADDRESS_MODE::ABY, 7, true  },{ "NOP", ADDRESS_MODE::ABX, 4, true  },{ "ADC", ADDRESS_MODE::ABX, 4, false },{ "ROR", ADDRESS_MODE::ABX, 7, false },{ "RRA", ADDRESS_MODE::ABX, 7, true  },
+/*  8x  */	{ "NOP", ADDRESS_MODE::IMM, 2, true  },{ "STA", ADDRESS_MODE::IZX, 6, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "SAX", ADDRESS_MODE::IZX, 6, true  },{ "STY", ADDRESS_MODE::ZP0, 3, false },{ "STA", ADDRESS_MODE::ZP0, 3, false },{ "STX", ADDRESS_MODE::ZP0, 3, false },{ "SAX", ADDRESS_MODE::ZP0, 3, true  },{ "DEY", ADDRESS_MODE::IMP, 2, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "TXA", ADDRESS_MODE::IMP, 2, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "STY", ADDRESS_MODE::ABS, 4, false },{ "STA", ADDRESS_MODE::ABS, 4, false },{ "STX", ADDRESS_MODE::ABS, 4, false },{ "SAX", ADDRESS_MODE::ABS, 4, true  },
+/*  9x  */	{ "BCC", ADDRESS_MODE::REL, 2, false },{ "STA", ADDRESS_MODE::IZY, 6, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "???", ADDRESS_MODE::IMP, 6, true  },{ "STY", ADDRESS_MODE::ZPX, 4, false },{ "STA", ADDRESS_MODE::ZPX, 4, false },{ "STX", ADDRESS_MODE::ZPY, 4, false },{ "SAX", ADDRESS_MODE::ZPY, 4, true  },{ "TYA", ADDRESS_MODE::IMP, 2, false },{ "STA", ADDRESS_MODE::ABY, 5, false },{ "TXS", ADDRESS_MODE::IMP, 2, false },{ "???", ADDRESS_MODE::IMP, 5, true  },{ "NOP", ADDRESS_MODE::ABX, 5, true  },{ "STA", ADDRESS_MODE::ABX, 5, false },{ "???", ADDRESS_MODE::IMP, 5, true  },{ "???", ADDRESS_MODE::IMP, 5, true  },
+/*  Ax  */	{ "LDY", ADDRESS_MODE::IMM, 2, false },{ "LDA", ADDRESS_MODE::IZX, 6, false },{ "LDX", ADDRESS_MODE::IMM, 2, false },{ "LAX", ADDRESS_MODE::IZX, 6, true  },{ "LDY", ADDRESS_MODE::ZP0, 3, false },{ "LDA", ADDRESS_MODE::ZP0, 3, false },{ "LDX", ADDRESS_MODE::ZP0, 3, false },{ "LAX", ADDRESS_MODE::ZP0, 3, true  },{ "TAY", ADDRESS_MODE::IMP, 2, false },{ "LDA", ADDRESS_MODE::IMM, 2, false },{ "TAX", ADDRESS_MODE::IMP, 2, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "LDY", ADDRESS_MODE::ABS, 4, false },{ "LDA", ADDRESS_MODE::ABS, 4, false },{ "LDX", ADDRESS_MODE::ABS, 4, false },{ "LAX", ADDRESS_MODE::ABS, 4, true  },
+/*  Bx  */	{ "BCS", ADDRESS_MODE::REL, 2, false },{ "LDA", ADDRESS_MODE::IZY, 5, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "LAX", ADDRESS_MODE::IZY, 5, true  },{ "LDY", ADDRESS_MODE::ZPX, 4, false },{ "LDA", ADDRESS_MODE::ZPX, 4, false },{ "LDX", ADDRESS_MODE::ZPY, 4, false },{ "LAX", ADDRESS_MODE::ZPY, 4, true  },{ "CLV", ADDRESS_MODE::IMP, 2, false },{ "LDA", ADDRESS_MODE::ABY, 4, false },{ "TSX", ADDRESS_MODE::IMP, 2, false },{ "???", ADDRESS_MODE::IMP, 4, true  },{ "LDY", ADDRESS_MODE::ABX, 4, false },{ "LDA", ADDRESS_MODE::ABX, 4, false },{ "LDX", ADDRESS_MODE::ABY, 4, false },{ "LAX", ADDRESS_MODE::ABY, 4, true  },
+/*  Cx  */	{ "CPY", ADDRESS_MODE::IMM, 2, false },{ "CMP", ADDRESS_MODE::IZX, 6, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "DCP", ADDRESS_MODE::IZX, 8, true  },{ "CPY", ADDRESS_MODE::ZP0, 3, false },{ "CMP", ADDRESS_MODE::ZP0, 3, false },{ "DEC", ADDRESS_MODE::ZP0, 5, false },{ "DCP", ADDRESS_MODE::ZP0, 5, true  },{ "INY", ADDRESS_MODE::IMP, 2, false },{ "CMP", ADDRESS_MODE::IMM, 2, false },{ "DEX", ADDRESS_MODE::IMP, 2, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "CPY", ADDRESS_MODE::ABS, 4, false },{ "CMP", ADDRESS_MODE::ABS, 4, false },{ "DEC", ADDRESS_MODE::ABS, 6, false },{ "DCP", ADDRESS_MODE::ABS, 6, true  },
+/*  Dx  */	{ "BNE", ADDRESS_MODE::REL, 2, false },{ "CMP", ADDRESS_MODE::IZY, 5, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "DCP", ADDRESS_MODE::IZY, 8, true  },{ "NOP", ADDRESS_MODE::ZPX, 4, true  },{ "CMP", ADDRESS_MODE::ZPX, 4, false },{ "DEC", ADDRESS_MODE::ZPX, 6, false },{ "DCP", ADDRESS_MODE::ZPX, 6, true  },{ "CLD", ADDRESS_MODE::IMP, 2, false },{ "CMP", ADDRESS_MODE::ABY, 4, false },{ "NOP", ADDRESS_MODE::IMP, 2, true  },{ "DCP", ADDRESS_MODE::ABY, 7, true  },{ "NOP", ADDRESS_MODE::ABX, 4, true  },{ "CMP", ADDRESS_MODE::ABX, 4, false },{ "DEC", ADDRESS_MODE::ABX, 7, false },{ "DCP", ADDRESS_MODE::ABX, 7, true  },
+/*  Ex  */	{ "CPX", ADDRESS_MODE::IMM, 2, false },{ "SBC", ADDRESS_MODE::IZX, 6, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "ISB", ADDRESS_MODE::IZX, 8, true  },{ "CPX", ADDRESS_MODE::ZP0, 3, false },{ "SBC", ADDRESS_MODE::ZP0, 3, false },{ "INC", ADDRESS_MODE::ZP0, 5, false },{ "ISB", ADDRESS_MODE::ZP0, 5, true  },{ "INX", ADDRESS_MODE::IMP, 2, false },{ "SBC", ADDRESS_MODE::IMM, 2, false },{ "NOP", ADDRESS_MODE::IMP, 2, false },{ "SBC", ADDRESS_MODE::IMM, 2, true  },{ "CPX", ADDRESS_MODE::ABS, 4, false },{ "SBC", ADDRESS_MODE::ABS, 4, false },{ "INC", ADDRESS_MODE::ABS, 6, false },{ "ISB", ADDRESS_MODE::ABS, 6, true  },
+/*  Fx  */	{ "BEQ", ADDRESS_MODE::REL, 2, false },{ "SBC", ADDRESS_MODE::IZY, 5, false },{ "???", ADDRESS_MODE::IMP, 2, true  },{ "ISB", ADDRESS_MODE::IZY, 8, true  },{ "NOP", ADDRESS_MODE::ZPX, 4, true  },{ "SBC", ADDRESS_MODE::ZPX, 4, false },{ "INC", ADDRESS_MODE::ZPX, 6, false },{ "ISB", ADDRESS_MODE::ZPX, 6, true  },{ "SED", ADDRESS_MODE::IMP, 2, false },{ "SBC", ADDRESS_MODE::ABY, 4, false },{ "NOP", ADDRESS_MODE::IMP, 2, true  },{ "ISB", ADDRESS_MODE::ABY, 7, true  },{ "NOP", ADDRESS_MODE::ABX, 4, true  },{ "SBC", ADDRESS_MODE::ABX, 4, false },{ "INC", ADDRESS_MODE::ABX, 7, false },{ "ISB", ADDRESS_MODE::ABX, 7, true  },
+}};
+
+
+// Bytes taken by an instruction, opcode included
+inline constexpr uint8_t instructionLength(ADDRESS_MODE addressMode) {
+	switch (addressMode) {
+	case ADDRESS_MODE::IMP:
+		return 1;
+	case ADDRESS_MODE::ABS: case ADDRESS_MODE::ABX:
+	case ADDRESS_MODE::ABY: case ADDRESS_MODE::IND:
+		return 3;
+	default:
+		return 2;
+	}
+}
+
+// Branches, jumps, calls, returns and BRK, execution
+// doesn't simply fall through to the next instruction
+inline constexpr bool isControlFlow(uint8_t opcode) {
+	return opcodeTable[opcode].addressMode == ADDRESS_MODE::REL ||
+		opcode == 0x00 || opcode == 0x20 || opcode == 0x40 ||
+		opcode == 0x4C || opcode == 0x60 || opcode == 0x6C;
+}
@@ -6,3 +6,20 @@
 #define MEM_DUMP_FILE_PATH "./logs/memdump.log"
 
 //#define _LOG
+
+// Build the SDL window front end (SdlFrameSink.cpp), without
+// it the emulator runs headless and needs no SDL at all
+#define SDL_FRONTEND
+
+// Execute opcodes through a switch of fused handlers (CPU_6502_Dispatch.cpp)
+// instead of the lookup table of member function pointers
+#define CPU_SWITCH_DISPATCH
+
+// Turn lines of palette indices into colors with SSE4.1/AVX2 kernels
+// (NesPixelComposer.cpp), picked at runtime by what the host supports.
+// x86 hosts only, elsewhere the scalar loop runs.
+#define PPU_SIMD
+
+#if defined(PPU_SIMD) && !(defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#undef PPU_SIMD
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+
+// Receives the samples the APU synthesizes (mono, 16 bit). Front ends (an
+// audio device, a recorder) implement this, the system runs silent and
+// skips synthesis without one.
+class IAudioSink {
+public:
+	// Asked once when the sink is set
+	virtual size_t sampleRate() = 0;
+
+	// Called on the emulation thread after every frame with its
+	// samples, the buffer is only valid during the call
+	virtual void samplesReady(const int16_t* samples, size_t count) = 0;
+
+	// Sinks played on another clock (a sound card's) return how much to
+	// scale the sample rate by for the next frame to keep up with it
+	virtual double rateRatio() { return 1.0; }
+
+	virtual ~IAudioSink() {}
+};
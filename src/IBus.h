@@ -6,9 +6,21 @@
 #include "IBusSlave.h"
 
 
+// Host memory window for one page of the address space, accessed
+// as data[address & mask]. Pages with side effects leave data null.
+template <typename addressWidth, typename dataWidth>
+struct DirectPage {
+	dataWidth*	 data	  = nullptr;
+	addressWidth mask	  = 0;
+	bool		 writable = false;
+};
+
+
 template <typename addressWidth, typename dataWidth>
 class IBus {
 public:
+	static const size_t directPageSize = 0x100;
+
 	virtual void mapSlave(std::shared_ptr<IBusSlave<addressWidth, dataWidth>> slave,
 		addressWidth startAddress, addressWidth endAddress) = 0;
 
@@ -20,9 +32,26 @@ public:
 	virtual bool write(addressWidth address, dataWidth data) = 0;
 	virtual dataWidth read(addressWidth address, bool readOnly = false) = 0;
 
+	// Table of (maxAddress + 1) / directPageSize pages that masters may
+	// access directly, buses without the capability publish no pages
+	virtual const DirectPage<addressWidth, dataWidth>* directPages() {
+		static const DirectPage<addressWidth, dataWidth>
+			noPages[(maxAddress + 1) / directPageSize] = {};
+
+		return noPages;
+	}
+
+	// Changes whenever the direct pages were republished (e.g. after a bank switch)
+	virtual uint32_t mappingVersion() { return 0; }
+
 	virtual void dump_memory(const char* filePath,
 		addressWidth startAddress = 0, addressWidth endAddresss = maxAddress) = 0;
 
+	// Buses hold no state of their own, but restoring the slaves'
+	// may change the memory they publish as direct pages
+	virtual void serialize(StateWriter& writer) {}
+	virtual void deserialize(StateReader& reader) {}
+
 protected:
 	static const size_t maxAddress = std::numeric_limits<addressWidth>::max();
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "NesState.h"
+
 template<typename addressWidth, typename dataWidth>
 class IBusSlave {
 public:
@@ -7,5 +9,19 @@ public:
 	virtual dataWidth read(addressWidth address, bool readOnly = false) = 0;
 	virtual void write(addressWidth address, dataWidth data) = 0;
 
+	// Publishes the host memory behind the page starting at pageAddress,
+	// so that the bus can serve it without calling read/write.
+	// Slaves whose accesses have side effects keep the default.
+	virtual bool directMemory(addressWidth pageAddress, dataWidth*& data,
+		addressWidth& mask, bool& writable) { return false; }
+
+	// Changes whenever directMemory would publish other memory (e.g. a
+	// mapper switched banks), buses only look again when it does
+	virtual uint32_t mappingVersion() { return 0; }
+
+	// Save state support, slaves without state keep the defaults
+	virtual void serialize(StateWriter& writer) {}
+	virtual void deserialize(StateReader& reader) {}
+
 	virtual ~IBusSlave() {}
 };
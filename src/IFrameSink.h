@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+
+// Pixel layout of the PPU's framebuffer, byte order RGBA
+// so it can be uploaded as an RGBA32 texture as is
+struct NesColor {
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+	uint8_t a;
+};
+
+
+// Receives the frames the PPU renders into its own framebuffer. Front ends
+// (a window, a video encoder, an observation buffer) implement this, the PPU
+// runs headless without one.
+class IFrameSink {
+public:
+	static const size_t frameWidth	= 256;
+	static const size_t frameHeight = 240;
+
+	// Called once per frame, the buffer is only valid during the call
+	virtual void frameComplete(const NesColor* frame) = 0;
+
+	// Sinks the user can close (e.g. windows) stop the system this way
+	virtual bool isOpen() { return true; }
+
+	virtual ~IFrameSink() {}
+};
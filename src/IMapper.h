@@ -3,6 +3,8 @@
 #include <cstdint>
 #include "fmt/printf.h"
 
+#include "NesState.h"
+
 
 enum class MIRROR_MODE {
 	SOLDERED,
@@ -18,7 +20,10 @@ public:
 	IMapper(uint8_t prgBanks, uint8_t chrBanks) : 
 		m_PRGBanks(prgBanks), m_CHRBanks(chrBanks) {}
 
-	uint16_t mapRead(uint16_t address) {
+	// Returned by mapWrite when the mapper consumed the write itself
+	static const uint32_t unmapped = 0xFFFFFFFF;
+
+	uint32_t mapRead(uint16_t address) {
 		if (address >= 0x0000 && address <= 0x1FFF)
 			m_result = ppuRead(address);
 		if (address >= 0x8000 && address <= 0xFFFF)
@@ -31,21 +36,30 @@ public:
 		return -1;
 	}
 
-	uint16_t mapWrite(uint16_t address) {
+	uint32_t mapWrite(uint16_t address, uint8_t data) {
+		m_result = false;
+
 		if (address >= 0x0000 && address <= 0x1FFF)
-			return ppuWrite(address);
+			m_result = ppuWrite(address);
 		if (address >= 0x8000 && address <= 0xFFFF)
-			return cpuWrite(address);
+			m_result = cpuWrite(address, data);
 
 		if (m_result)
 			return m_mappedAddress;
 
-		fmt::print("MMC failed to map write address!\n");
-		return -1;
+		// Register writes (e.g. bank selects) don't reach memory
+		return unmapped;
 	}
 
 	virtual MIRROR_MODE getMirrorMode() = 0;
 
+	// Bumped whenever a register write changes what mapRead returns
+	uint32_t getBankVersion() const { return m_bankVersion; }
+
+	// Bank selection and other registers, for save states
+	virtual void serialize(StateWriter& writer) {}
+	virtual void deserialize(StateReader& reader) {}
+
 protected:
 	virtual bool cpuRead(uint16_t address) = 0;
 	virtual bool cpuWrite(uint16_t address, uint8_t data=0) = 0;
@@ -55,7 +69,8 @@ protected:
 
 protected:
 	bool m_result = false;
-	uint16_t m_mappedAddress = 0;
+	uint32_t m_mappedAddress = 0;
+	uint32_t m_bankVersion = 0;
 	uint8_t m_PRGBanks = 0;
 	uint8_t m_CHRBanks = 0;
 
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "IBusMaster.h"
+#include "NesState.h"
 
 
 class INesCpu : public IBusMaster<uint16_t, uint8_t> {
@@ -11,12 +12,33 @@ public:
 	virtual void reset() = 0;
 	virtual void reset(uint16_t pc) = 0;
 	virtual void tick() = 0;
+
+	// Instruction granular execution, both return the number of
+	// cycles the last instruction ran past the requested point
+	virtual size_t runCycles(size_t budget) = 0;
+	virtual size_t runUntil(size_t targetCycle) = 0;
+
+	// Makes a running runCycles/runUntil return after the current
+	// instruction, e.g. when a write may have raised an interrupt
+	virtual void endRun() = 0;
+
+	// Adds cycles to the current instruction, for DMA
+	// that halts the CPU while it uses the bus
+	virtual void stall(size_t nCycles) = 0;
+
 	virtual bool isFinished() = 0;
 	virtual const inline size_t getCyclesPassed() = 0;
 	virtual void nmi() = 0;
 	virtual void irq() = 0;
+
+	// Level triggered IRQ input, taken before any instruction that
+	// starts while it's asserted and interrupts aren't disabled
+	virtual void setIrqLine(bool asserted) = 0;
 	virtual std::string getLog() = 0;
 
+	virtual void serialize(StateWriter& writer) = 0;
+	virtual void deserialize(StateReader& reader) = 0;
+
 	virtual ~INesCpu() {}
 
 };
@@ -2,6 +2,14 @@
 
 #include "IBusMaster.h"
 #include "IBusSlave.h"
+#include "IFrameSink.h"
+#include "ITileSource.h"
+
+
+enum class RENDER_MODE {
+    DOT,        // One pixel per dot, follows mid line changes
+    SCANLINE    // Whole lines at once, much fewer bus reads
+};
 
 
 class INesPpu : public IBusMaster<uint16_t, uint8_t>,
@@ -17,4 +25,28 @@ public:
 
     virtual int inline getCycle()    = 0;
     virtual int inline getScanline() = 0;
+
+    // Frames completed since construction
+    virtual size_t getFrameCount() = 0;
+
+    // The PPU renders into a framebuffer it owns and hands
+    // it to the sink, if there is one, once per frame
+    virtual void setFrameSink(std::shared_ptr<IFrameSink> sink) = 0;
+    virtual const NesColor* getFrameBuffer() = 0;
+
+    // Decoded pattern rows, usually the cartridge's tile cache. Without
+    // one the PPU reads and decodes the bitplanes over its bus.
+    virtual void setTileSource(std::shared_ptr<ITileSource> source) = 0;
+
+    // Switching also clears the framebuffer
+    virtual void setRenderMode(RENDER_MODE mode) = 0;
+
+    // OAM DMA ($4014), 256 bytes copied in from OAMADDR on
+    virtual void writeOam(const uint8_t* data) = 0;
+
+    // Dots before the tick that raises NMI (SIZE_MAX if none will until
+    // $2000 is written) or completes the frame, so the system can run
+    // the CPU ahead and only catch the PPU up when it has to
+    virtual size_t dotsUntilNmi() = 0;
+    virtual size_t dotsUntilFrameEnd() = 0;
 };
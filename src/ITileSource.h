@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Pattern rows already expanded to one pixel (0-3) per byte, leftmost
+// pixel in the lowest byte, so a renderer gets 8 pixels with one load
+class ITileSource {
+public:
+	// Row of the tile at a PPU pattern address ($0000-$1FFF), the
+	// low 3 bits pick the row and bit 3 (the bitplane) is ignored
+	virtual uint64_t tileRow(uint16_t address) = 0;
+
+	// Changes whenever any row might have (CHR writes, bank switches),
+	// so views built from the rows know when to rebuild
+	virtual uint32_t tileVersion() = 0;
+
+	virtual ~ITileSource() {}
+};
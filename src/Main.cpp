@@ -1,14 +1,19 @@
 #include <memory>
 
+#include "Config.h"
+
+#ifdef SDL_FRONTEND
 #include "sdl/SDL.h"
+#include "SdlFrameSink.h"
+#include "SdlAudioOutput.h"
+#endif
 
-#include "Config.h"
 #include "filesystem.h"
 #include "NesCore.h"
 #include "CPU_6502.h"
 #include "PPU_2C02.h"
 #include "NesArrayRam.h"
-#include "NesMultiMapBus.h"
+#include "NesPageTableBus.h"
 
 
 int main(int argc, char** argv) {
@@ -16,15 +21,34 @@ int main(int argc, char** argv) {
 	if (!POCNES::dirExists(LOGS_FOLDER_PATH))
 		POCNES::makedir(LOGS_FOLDER_PATH);
 
-	// Create the system instance
-	NesCore nes(
-		std::make_shared<CPU_6502>(),
-		std::make_shared<PPU_2C02>(),
+	std::shared_ptr<PPU_2C02> ppu = std::make_shared<PPU_2C02>();
+
+#ifdef SDL_FRONTEND
+	// Without a sink the PPU only fills its framebuffer
+	ppu->setFrameSink(std::make_shared<SdlFrameSink>(ppu.get()));
+#endif
+
+	// Create the system instance, use NesCore with
+	// CPU_6502<> to swap components while debugging or
+	// NesCachedCore with CPU_6502_Cached to A/B the block cache
+	NesFastCore nes(
+		std::make_shared<CPU_6502<NesPageTableBus>>(),
+		ppu,
 		std::make_shared<NesArrayRam>(0x0800),
-		std::make_shared<NesMultiMapBus>(),
-		std::make_shared<NesMultiMapBus>()
+		std::make_shared<NesPageTableBus>(),
+		std::make_shared<NesPageTableBus>()
 	);
 
+#ifdef SDL_FRONTEND
+	// The ring is the only thing the emulation and audio threads share.
+	// Frames aren't synced to the display, so the sound card paces them.
+	std::shared_ptr<NesAudioRing> audioRing = std::make_shared<NesAudioRing>(48000, 40, true);
+	SdlAudioOutput audioOutput(audioRing);
+
+	if (audioOutput.isOpen())
+		nes.setAudioSink(audioRing);
+#endif
+
 	//nes.nesTest(NESTEST_FILE_PATH, MEM_DUMP_FILE_PATH);
 
 	nes.loadCartridge("./roms/games/dk.nes");
@@ -33,7 +33,15 @@ private:
 		return false;
 	}
 
-	bool ppuWrite(uint16_t address) override { return false; }
+	bool ppuWrite(uint16_t address) override {
+		// Only CHR RAM is writable
+		if (m_CHRBanks == 0 && address <= 0x1FFF) {
+			m_mappedAddress = address;
+			return true;
+		}
+
+		return false;
+	}
 	// ------------
 
 };
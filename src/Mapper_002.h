@@ -12,6 +12,19 @@ public:
 		return MIRROR_MODE::SOLDERED;
 	}
 
+	void serialize(StateWriter& writer) override {
+		writer.write(selectedBankLo);
+		writer.write(selectedBankHi);
+	}
+
+	void deserialize(StateReader& reader) override {
+		reader.read(selectedBankLo);
+		reader.read(selectedBankHi);
+		reader.check(selectedBankLo < m_PRGBanks && selectedBankHi < m_PRGBanks,
+			"Save state PRG bank is out of range");
+		m_bankVersion++;
+	}
+
 private:
 	// From IMapper
 	bool cpuRead(uint16_t address) override {
@@ -27,10 +40,16 @@ private:
 		return false;
 	}
 
-	bool cpuWrite(uint16_t address, uint8_t data) override { 
-		selectedBankLo = data & 0x0F;
+	bool cpuWrite(uint16_t address, uint8_t data) override {
+		// Any write to $8000-$FFFF selects the bank at $8000-$BFFF,
+		// boards with fewer banks don't decode the upper bits
+		uint8_t bank = (data & 0x0F) % m_PRGBanks;
+		if (selectedBankLo != bank) {
+			selectedBankLo = bank;
+			m_bankVersion++;
+		}
 
-		return true;
+		return false;
 	}
 
 	bool ppuRead(uint16_t address) override {
@@ -42,7 +61,15 @@ private:
 		return false;
 	}
 
-	bool ppuWrite(uint16_t address) override { return false; }
+	bool ppuWrite(uint16_t address) override {
+		// Only CHR RAM is writable
+		if (m_CHRBanks == 0 && address <= 0x1FFF) {
+			m_mappedAddress = address;
+			return true;
+		}
+
+		return false;
+	}
 	// ------------
 
 private:
@@ -0,0 +1,842 @@
+#include <algorithm>
+
+#include "NesApu.h"
+
+
+//	+-----------------------+
+//	|		 Tables			|
+//	+-----------------------+
+
+// Length counter loads, indexed by the top 5 bits of $4003/7/B/F
+static const uint8_t lengthTable[32] = {
+	 10, 254,  20,   2,  40,   4,  80,   6, 160,   8,  60,  10,  14,  12,  26,  14,
+	 12,  16,  24,  18,  48,  20,  96,  22, 192,  24,  72,  26,  16,  28,  32,  30
+};
+
+// Pulse waveforms, bit n is step n
+static const uint8_t dutyTable[4] = { 0x02, 0x06, 0x1E, 0xF9 };
+
+static const uint8_t triangleTable[32] = {
+	15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  0,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15
+};
+
+// Timer periods in CPU cycles (NTSC)
+static const uint16_t noiseTable[16] = {
+	4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068
+};
+
+// The noise LFSR is linear, so any number of steps is a 15x15 bit
+// matrix. bits[mode][k][b] is what bit b becomes after 2^k steps.
+struct NoiseJumps {
+	uint16_t bits[2][32][15] = {};
+};
+
+static constexpr uint16_t noiseApply(const uint16_t (&bits)[15], uint16_t shift) {
+	uint16_t result = 0;
+	for (int b = 0; b < 15; b++)
+		if ((shift >> b) & 0x01)
+			result ^= bits[b];
+	return result;
+}
+
+static constexpr NoiseJumps makeNoiseJumps() {
+	NoiseJumps jumps;
+	for (int mode = 0; mode < 2; mode++) {
+		const int tap = mode ? 6 : 1;
+		for (int b = 0; b < 15; b++) {
+			uint16_t shift = 1 << b;
+			uint16_t feedback = (shift ^ (shift >> tap)) & 0x01;
+			jumps.bits[mode][0][b] = (shift >> 1) | (feedback << 14);
+		}
+		for (int k = 1; k < 32; k++)
+			for (int b = 0; b < 15; b++)
+				jumps.bits[mode][k][b] = noiseApply(jumps.bits[mode][k - 1], jumps.bits[mode][k - 1][b]);
+	}
+	return jumps;
+}
+
+static constexpr NoiseJumps noiseJumps = makeNoiseJumps();
+
+static const uint16_t dmcTable[16] = {
+	428, 380, 340, 320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54
+};
+
+// Frame counter steps in CPU cycles, the sequence restarts a cycle after
+// the last one. The 4 step sequence raises the frame IRQ on its last step.
+static const int32_t frameSteps[2][4] = {
+	{ 7457, 14913, 22371, 29829 },
+	{ 7457, 14913, 22371, 37281 }
+};
+
+// Linear mix of the DAC's levels, per unit of a channel's output
+static const int32_t pulseWeight	= 246;	// 0.00752 * 32767
+static const int32_t triangleWeight = 279;	// 0.00851 * 32767
+static const int32_t noiseWeight	= 162;	// 0.00494 * 32767
+static const int32_t dmcWeight		= 110;	// 0.00335 * 32767
+
+
+NesApu::NesApu(MemoryReader readMemory) : m_readMemory(readMemory) {
+	m_pulseOutput[0].weight = pulseWeight;
+	m_pulseOutput[1].weight = pulseWeight;
+	m_triangleOutput.weight = triangleWeight;
+	m_noiseOutput.weight = noiseWeight;
+	m_dmcOutput.weight = dmcWeight;
+
+	reset(0);
+}
+
+
+void NesApu::reset(size_t cycle) {
+	m_pulse[0] = Pulse();
+	m_pulse[1] = Pulse();
+	m_triangle = Triangle();
+	m_noise = Noise();
+	m_dmc = Dmc();
+	m_dmc.period = dmcTable[0];
+	m_noise.period = noiseTable[0];
+
+	m_enabled = 0x00;
+	m_fiveStep = false;
+	m_irqInhibit = false;
+	m_frameIrq = false;
+	m_frameCycle = 0;
+	m_frameStep = 0;
+
+	m_cycle = cycle;
+	m_frameStart = cycle;
+	m_stallCycles = 0;
+
+	if (m_buffer != nullptr)
+		m_buffer->clear();
+
+	for (Output* output : { &m_pulseOutput[0], &m_pulseOutput[1],
+		&m_triangleOutput, &m_noiseOutput, &m_dmcOutput })
+		output->level = 0;
+}
+
+
+// Runs to the next frame counter step (or the target) at a time, so the
+// channels see its changes when they happen. Each stretch ends a frame
+// of the buffer, which keeps the buffer's times small.
+void NesApu::run(size_t cycle) {
+	// Enabled with the buffer empty, the reader fills it right away
+	// (even when no time passed, cyclesUntilEvent() is 0 until it did)
+	if (!m_dmc.bufferFull && m_dmc.bytesRemaining > 0)
+		m_fetchDmc();
+
+	while (m_cycle < cycle) {
+		uint64_t step = m_cycle + (frameSteps[m_fiveStep][m_frameStep] - m_frameCycle);
+		uint64_t end = std::min<uint64_t>(cycle, step);
+
+		uint32_t from = (uint32_t)(m_cycle - m_frameStart);
+		uint32_t to = (uint32_t)(end - m_frameStart);
+
+		m_runPulse(m_pulse[0], m_pulseOutput[0], false, from, to);
+		m_runPulse(m_pulse[1], m_pulseOutput[1], true, from, to);
+		m_runTriangle(from, to);
+		m_runNoise(from, to);
+		m_runDmc(from, to);
+
+		m_frameCycle += (int32_t)(end - m_cycle);
+		m_cycle = end;
+
+		if (end == step)
+			m_clockFrameCounter();
+
+		if (m_buffer != nullptr)
+			m_buffer->endFrame(to);
+
+		m_frameStart = m_cycle;
+	}
+}
+
+
+size_t NesApu::cyclesUntilEvent() const {
+	size_t cycles = SIZE_MAX;
+
+	// The flag only has to be raised once
+	if (!m_fiveStep && !m_irqInhibit && !m_frameIrq)
+		cycles = frameSteps[0][3] - m_frameCycle;
+
+	// The reader fetches whenever the buffer is empty, which is when
+	// the output unit starts on its next byte. A timer clock is only
+	// done once the run goes past it, hence the extra cycle.
+	if (m_dmc.bytesRemaining > 0) {
+		size_t fetch = 0;
+		if (m_dmc.bufferFull)
+			fetch = m_dmc.delay + (size_t)(m_dmc.bitsRemaining - 1) * m_dmc.period + 1;
+
+		cycles = std::min(cycles, fetch);
+	}
+
+	return cycles;
+}
+
+
+size_t NesApu::takeStallCycles() {
+	size_t cycles = m_stallCycles;
+	m_stallCycles = 0;
+
+	return cycles;
+}
+
+
+void NesApu::setSampleRate(size_t sampleRate) {
+	if (sampleRate == 0)
+		m_buffer = nullptr;
+	else
+		// Stretches are never longer than a whole frame counter sequence
+		m_buffer = std::make_unique<NesBlipBuffer>((double)clockRate, (double)sampleRate, frameSteps[1][3] + 1);
+}
+
+
+// Takes effect from the next run on
+void NesApu::setRateRatio(double ratio) {
+	if (m_buffer != nullptr)
+		m_buffer->setRatio(ratio);
+}
+
+
+size_t NesApu::samplesAvailable() const {
+	return (m_buffer != nullptr) ? m_buffer->samplesAvailable() : 0;
+}
+
+
+size_t NesApu::readSamples(int16_t* buffer, size_t maxSamples) {
+	return (m_buffer != nullptr) ? m_buffer->readSamples(buffer, maxSamples) : 0;
+}
+
+
+//	+-----------------------+
+//	|		Registers		|
+//	+-----------------------+
+
+uint8_t NesApu::read(uint16_t address, bool readOnly) {
+	// Everything else is write only
+	if (address != 0x4015)
+		return 0x00;
+
+	uint8_t status = 0x00;
+	status |= (m_pulse[0].length > 0) ? 0x01 : 0x00;
+	status |= (m_pulse[1].length > 0) ? 0x02 : 0x00;
+	status |= (m_triangle.length > 0) ? 0x04 : 0x00;
+	status |= (m_noise.length > 0) ? 0x08 : 0x00;
+	status |= (m_dmc.bytesRemaining > 0) ? 0x10 : 0x00;
+	status |= m_frameIrq ? 0x40 : 0x00;
+	status |= m_dmc.irq ? 0x80 : 0x00;
+
+	// Reading acknowledges the frame IRQ
+	if (!readOnly)
+		m_frameIrq = false;
+
+	return status;
+}
+
+
+void NesApu::write(uint16_t address, uint8_t data) {
+	switch (address) {
+	// Pulse 1 and 2
+	case 0x4000:
+	case 0x4004: {
+		Pulse& pulse = m_pulse[(address >> 2) & 0x01];
+		pulse.duty = data >> 6;
+		pulse.envelope.loop = data & 0x20;
+		pulse.envelope.constant = data & 0x10;
+		pulse.envelope.period = data & 0x0F;
+		break;
+	}
+	case 0x4001:
+	case 0x4005: {
+		Pulse& pulse = m_pulse[(address >> 2) & 0x01];
+		pulse.sweepEnabled = data & 0x80;
+		pulse.sweepPeriod = (data >> 4) & 0x07;
+		pulse.sweepNegate = data & 0x08;
+		pulse.sweepShift = data & 0x07;
+		pulse.sweepReload = true;
+		break;
+	}
+	case 0x4002:
+	case 0x4006: {
+		Pulse& pulse = m_pulse[(address >> 2) & 0x01];
+		pulse.period = (pulse.period & 0x0700) | data;
+		break;
+	}
+	case 0x4003:
+	case 0x4007: {
+		const int channel = (address >> 2) & 0x01;
+		Pulse& pulse = m_pulse[channel];
+		pulse.period = (pulse.period & 0x00FF) | ((data & 0x07) << 8);
+
+		if (m_enabled & (1 << channel))
+			pulse.length = lengthTable[data >> 3];
+
+		pulse.step = 0;
+		pulse.envelope.start = true;
+		break;
+	}
+
+	// Triangle
+	case 0x4008:
+		m_triangle.control = data & 0x80;
+		m_triangle.linearPeriod = data & 0x7F;
+		break;
+	case 0x400A:
+		m_triangle.period = (m_triangle.period & 0x0700) | data;
+		break;
+	case 0x400B:
+		m_triangle.period = (m_triangle.period & 0x00FF) | ((data & 0x07) << 8);
+
+		if (m_enabled & 0x04)
+			m_triangle.length = lengthTable[data >> 3];
+
+		m_triangle.linearReload = true;
+		break;
+
+	// Noise
+	case 0x400C:
+		m_noise.envelope.loop = data & 0x20;
+		m_noise.envelope.constant = data & 0x10;
+		m_noise.envelope.period = data & 0x0F;
+		break;
+	case 0x400E:
+		m_noise.shortMode = data & 0x80;
+		m_noise.period = noiseTable[data & 0x0F];
+		break;
+	case 0x400F:
+		if (m_enabled & 0x08)
+			m_noise.length = lengthTable[data >> 3];
+
+		m_noise.envelope.start = true;
+		break;
+
+	// DMC
+	case 0x4010:
+		m_dmc.irqEnabled = data & 0x80;
+		m_dmc.loop = data & 0x40;
+		m_dmc.period = dmcTable[data & 0x0F];
+
+		if (!m_dmc.irqEnabled)
+			m_dmc.irq = false;
+		break;
+	case 0x4011:
+		m_dmc.level = data & 0x7F;
+		break;
+	case 0x4012:
+		m_dmc.sampleAddress = 0xC000 + data * 64;
+		break;
+	case 0x4013:
+		m_dmc.sampleLength = data * 16 + 1;
+		break;
+
+	// Status
+	case 0x4015:
+		m_enabled = data & 0x0F;
+
+		// Disabling a channel silences it right away
+		if (!(data & 0x01)) m_pulse[0].length = 0;
+		if (!(data & 0x02)) m_pulse[1].length = 0;
+		if (!(data & 0x04)) m_triangle.length = 0;
+		if (!(data & 0x08)) m_noise.length = 0;
+
+		// The DMC finishes the byte it's playing either way,
+		// the reader fetches the first byte on the next run
+		if (!(data & 0x10))
+			m_dmc.bytesRemaining = 0;
+		else if (m_dmc.bytesRemaining == 0)
+			m_restartDmc();
+
+		m_dmc.irq = false;
+		break;
+
+	// Frame counter, the new sequence starts right away (a few
+	// cycles early) and the 5 step one clocks everything first
+	case 0x4017:
+		m_fiveStep = data & 0x80;
+		m_irqInhibit = data & 0x40;
+
+		if (m_irqInhibit)
+			m_frameIrq = false;
+
+		m_frameCycle = 0;
+		m_frameStep = 0;
+
+		if (m_fiveStep) {
+			m_quarterFrame();
+			m_halfFrame();
+		}
+		break;
+	}
+}
+
+
+//	+-----------------------+
+//	|		Channels		|
+//	+-----------------------+
+
+void NesApu::m_update(Output& output, uint32_t time, int32_t level) {
+	int32_t delta = level - output.level;
+	if (delta == 0)
+		return;
+
+	output.level = level;
+
+	if (m_buffer != nullptr)
+		m_buffer->addDelta(time, delta * output.weight);
+}
+
+
+// The timer clocks every other CPU cycle, so a period of n
+// steps the sequencer every 2 * (n + 1) CPU cycles
+void NesApu::m_runPulse(Pulse& pulse, Output& output, bool second, uint32_t start, uint32_t end) {
+	const uint32_t period = (pulse.period + 1) * 2;
+	const uint8_t duty = dutyTable[pulse.duty];
+
+	uint8_t volume = m_pulseMuted(pulse, second) ? 0 : m_volume(pulse.envelope);
+	m_update(output, start, ((duty >> pulse.step) & 0x01) ? volume : 0);
+
+	uint32_t time = start + pulse.delay;
+
+	if (time < end) {
+		if (volume == 0) {
+			// Silent, only the sequencer's position has to move on
+			uint32_t count = (end - time - 1) / period + 1;
+			pulse.step = (pulse.step + count) & 0x07;
+			time += count * period;
+		}
+		else {
+			do {
+				pulse.step = (pulse.step + 1) & 0x07;
+				m_update(output, time, ((duty >> pulse.step) & 0x01) ? volume : 0);
+				time += period;
+			} while (time < end);
+		}
+	}
+
+	pulse.delay = time - end;
+}
+
+
+// Clocked every CPU cycle, the sequencer only moves while both
+// counters are non-zero and holds its level otherwise. Periods
+// below 2 are far above hearing, those are held too.
+void NesApu::m_runTriangle(uint32_t start, uint32_t end) {
+	const uint32_t period = m_triangle.period + 1;
+
+	m_update(m_triangleOutput, start, triangleTable[m_triangle.step]);
+
+	uint32_t time = start + m_triangle.delay;
+
+	if (time < end) {
+		uint32_t count = (end - time - 1) / period + 1;
+
+		if (m_triangle.length == 0 || m_triangle.linearCounter == 0 || m_triangle.period < 2) {
+			time += count * period;
+		}
+		else {
+			do {
+				m_triangle.step = (m_triangle.step + 1) & 0x1F;
+				m_update(m_triangleOutput, time, triangleTable[m_triangle.step]);
+				time += period;
+			} while (time < end);
+		}
+	}
+
+	m_triangle.delay = time - end;
+}
+
+
+// 15 bit LFSR, the output is silent while bit 0 is set
+void NesApu::m_runNoise(uint32_t start, uint32_t end) {
+	const uint32_t period = m_noise.period;
+	const int tap = m_noise.shortMode ? 6 : 1;
+
+	uint8_t volume = (m_noise.length == 0) ? 0 : m_volume(m_noise.envelope);
+	m_update(m_noiseOutput, start, (m_noise.shift & 0x01) ? 0 : volume);
+
+	uint32_t time = start + m_noise.delay;
+	uint16_t shift = m_noise.shift;
+
+	if (time < end) {
+		if (volume == 0) {
+			// Silent, jump the LFSR over the whole run at once
+			uint32_t count = (end - time - 1) / period + 1;
+			time += count * period;
+
+			for (int k = 0; count != 0; k++, count >>= 1)
+				if (count & 0x01)
+					shift = noiseApply(noiseJumps.bits[m_noise.shortMode][k], shift);
+		}
+		else {
+			do {
+				uint16_t feedback = (shift ^ (shift >> tap)) & 0x01;
+				shift = (shift >> 1) | (feedback << 14);
+				m_update(m_noiseOutput, time, (shift & 0x01) ? 0 : volume);
+				time += period;
+			} while (time < end);
+		}
+	}
+
+	m_noise.shift = shift;
+	m_noise.delay = time - end;
+}
+
+
+// Every timer clock the output unit moves the level by 2 per bit of the
+// byte it's playing. At the end of a byte it takes the next one from the
+// buffer, and the reader refills the buffer from memory right away.
+void NesApu::m_runDmc(uint32_t start, uint32_t end) {
+	const uint32_t period = m_dmc.period;
+
+	m_update(m_dmcOutput, start, m_dmc.level);
+
+	uint32_t time = start + m_dmc.delay;
+
+	while (time < end) {
+		// Nothing to play and nothing to fetch, only count bits
+		if (m_dmc.silence && !m_dmc.bufferFull && m_dmc.bytesRemaining == 0) {
+			uint32_t count = (end - time - 1) / period + 1;
+			m_dmc.bitsRemaining = (uint8_t)((m_dmc.bitsRemaining - 1 + 8 - count % 8) % 8 + 1);
+			time += count * period;
+			break;
+		}
+
+		if (!m_dmc.silence) {
+			if (m_dmc.shifter & 0x01) {
+				if (m_dmc.level <= 125)
+					m_dmc.level += 2;
+			}
+			else if (m_dmc.level >= 2) {
+				m_dmc.level -= 2;
+			}
+
+			m_update(m_dmcOutput, time, m_dmc.level);
+		}
+
+		m_dmc.shifter >>= 1;
+
+		if (--m_dmc.bitsRemaining == 0) {
+			m_dmc.bitsRemaining = 8;
+			m_dmc.silence = !m_dmc.bufferFull;
+
+			if (m_dmc.bufferFull) {
+				m_dmc.shifter = m_dmc.buffer;
+				m_dmc.bufferFull = false;
+
+				if (m_dmc.bytesRemaining > 0)
+					m_fetchDmc();
+			}
+		}
+
+		time += period;
+	}
+
+	m_dmc.delay = time - end;
+}
+
+
+void NesApu::m_restartDmc() {
+	m_dmc.address = m_dmc.sampleAddress;
+	m_dmc.bytesRemaining = m_dmc.sampleLength;
+}
+
+
+// The CPU is halted while the DMC uses its bus, 4 cycles in
+// most cases (1-4 depending on what the CPU was doing)
+void NesApu::m_fetchDmc() {
+	m_dmc.buffer = m_readMemory(m_dmc.address);
+	m_dmc.bufferFull = true;
+	m_stallCycles += 4;
+
+	m_dmc.address = (m_dmc.address == 0xFFFF) ? 0x8000 : m_dmc.address + 1;
+
+	if (--m_dmc.bytesRemaining == 0) {
+		if (m_dmc.loop)
+			m_restartDmc();
+		else if (m_dmc.irqEnabled)
+			m_dmc.irq = true;
+	}
+}
+
+
+//	+-----------------------+
+//	|	  Frame Counter		|
+//	+-----------------------+
+
+// The 5 step sequence's 4th step does nothing, so it isn't in the table
+// and both sequences are quarter, half, quarter, half frame steps
+void NesApu::m_clockFrameCounter() {
+	m_quarterFrame();
+
+	if (m_frameStep == 1 || m_frameStep == 3)
+		m_halfFrame();
+
+	if (m_frameStep == 3) {
+		if (!m_fiveStep && !m_irqInhibit)
+			m_frameIrq = true;
+
+		// The sequence starts over on the next cycle
+		m_frameCycle -= frameSteps[m_fiveStep][3] + 1;
+		m_frameStep = 0;
+	}
+	else {
+		m_frameStep++;
+	}
+}
+
+
+// Envelopes and the triangle's linear counter
+void NesApu::m_quarterFrame() {
+	m_clockEnvelope(m_pulse[0].envelope);
+	m_clockEnvelope(m_pulse[1].envelope);
+	m_clockEnvelope(m_noise.envelope);
+
+	if (m_triangle.linearReload)
+		m_triangle.linearCounter = m_triangle.linearPeriod;
+	else if (m_triangle.linearCounter > 0)
+		m_triangle.linearCounter--;
+
+	if (!m_triangle.control)
+		m_triangle.linearReload = false;
+}
+
+
+// Length counters and sweeps
+void NesApu::m_halfFrame() {
+	if (m_pulse[0].length > 0 && !m_pulse[0].envelope.loop)
+		m_pulse[0].length--;
+	if (m_pulse[1].length > 0 && !m_pulse[1].envelope.loop)
+		m_pulse[1].length--;
+	if (m_triangle.length > 0 && !m_triangle.control)
+		m_triangle.length--;
+	if (m_noise.length > 0 && !m_noise.envelope.loop)
+		m_noise.length--;
+
+	m_clockSweep(m_pulse[0], false);
+	m_clockSweep(m_pulse[1], true);
+}
+
+
+void NesApu::m_clockEnvelope(Envelope& envelope) {
+	if (envelope.start) {
+		envelope.start = false;
+		envelope.decay = 15;
+		envelope.divider = envelope.period;
+	}
+	else if (envelope.divider == 0) {
+		envelope.divider = envelope.period;
+
+		if (envelope.decay > 0)
+			envelope.decay--;
+		else if (envelope.loop)
+			envelope.decay = 15;
+	}
+	else {
+		envelope.divider--;
+	}
+}
+
+
+void NesApu::m_clockSweep(Pulse& pulse, bool second) {
+	if (pulse.sweepDivider == 0 && pulse.sweepEnabled && pulse.sweepShift > 0
+		&& !m_pulseMuted(pulse, second))
+		pulse.period = m_sweepTarget(pulse, second);
+
+	if (pulse.sweepDivider == 0 || pulse.sweepReload) {
+		pulse.sweepDivider = pulse.sweepPeriod;
+		pulse.sweepReload = false;
+	}
+	else {
+		pulse.sweepDivider--;
+	}
+}
+
+
+uint8_t NesApu::m_volume(const Envelope& envelope) const {
+	return envelope.constant ? envelope.period : envelope.decay;
+}
+
+
+// Pulse 1 negates with ones' complement, pulse 2 with two's
+uint16_t NesApu::m_sweepTarget(const Pulse& pulse, bool second) const {
+	int32_t change = pulse.period >> pulse.sweepShift;
+
+	if (pulse.sweepNegate)
+		change = second ? -change : -change - 1;
+
+	return (uint16_t)std::max(0, pulse.period + change);
+}
+
+
+// The sweep mutes the channel even while it isn't enabled
+bool NesApu::m_pulseMuted(const Pulse& pulse, bool second) const {
+	return pulse.length == 0 || pulse.period < 8 || m_sweepTarget(pulse, second) > 0x07FF;
+}
+
+
+//	+-----------------------+
+//	|	   Save States		|
+//	+-----------------------+
+
+// Only the registers and counters, the buffer starts over empty
+void NesApu::serialize(StateWriter& writer) {
+	for (Pulse& pulse : m_pulse) {
+		writer.write(pulse.envelope.start);
+		writer.write(pulse.envelope.loop);
+		writer.write(pulse.envelope.constant);
+		writer.write(pulse.envelope.period);
+		writer.write(pulse.envelope.divider);
+		writer.write(pulse.envelope.decay);
+		writer.write(pulse.duty);
+		writer.write(pulse.step);
+		writer.write(pulse.period);
+		writer.write(pulse.delay);
+		writer.write(pulse.length);
+		writer.write(pulse.sweepEnabled);
+		writer.write(pulse.sweepNegate);
+		writer.write(pulse.sweepReload);
+		writer.write(pulse.sweepPeriod);
+		writer.write(pulse.sweepShift);
+		writer.write(pulse.sweepDivider);
+	}
+
+	writer.write(m_triangle.control);
+	writer.write(m_triangle.linearReload);
+	writer.write(m_triangle.linearPeriod);
+	writer.write(m_triangle.linearCounter);
+	writer.write(m_triangle.step);
+	writer.write(m_triangle.period);
+	writer.write(m_triangle.delay);
+	writer.write(m_triangle.length);
+
+	writer.write(m_noise.envelope.start);
+	writer.write(m_noise.envelope.loop);
+	writer.write(m_noise.envelope.constant);
+	writer.write(m_noise.envelope.period);
+	writer.write(m_noise.envelope.divider);
+	writer.write(m_noise.envelope.decay);
+	writer.write(m_noise.shortMode);
+	writer.write(m_noise.shift);
+	writer.write(m_noise.period);
+	writer.write(m_noise.delay);
+	writer.write(m_noise.length);
+
+	writer.write(m_dmc.irqEnabled);
+	writer.write(m_dmc.loop);
+	writer.write(m_dmc.irq);
+	writer.write(m_dmc.period);
+	writer.write(m_dmc.delay);
+	writer.write(m_dmc.level);
+	writer.write(m_dmc.sampleAddress);
+	writer.write(m_dmc.sampleLength);
+	writer.write(m_dmc.address);
+	writer.write(m_dmc.bytesRemaining);
+	writer.write(m_dmc.buffer);
+	writer.write(m_dmc.bufferFull);
+	writer.write(m_dmc.shifter);
+	writer.write(m_dmc.bitsRemaining);
+	writer.write(m_dmc.silence);
+
+	writer.write(m_enabled);
+	writer.write(m_fiveStep);
+	writer.write(m_irqInhibit);
+	writer.write(m_frameIrq);
+	writer.write(m_frameCycle);
+	writer.write(m_frameStep);
+
+	writer.write(m_cycle);
+	writer.write((uint64_t)m_stallCycles);
+}
+
+
+void NesApu::deserialize(StateReader& reader) {
+	for (Pulse& pulse : m_pulse) {
+		reader.read(pulse.envelope.start);
+		reader.read(pulse.envelope.loop);
+		reader.read(pulse.envelope.constant);
+		reader.read(pulse.envelope.period);
+		reader.read(pulse.envelope.divider);
+		reader.read(pulse.envelope.decay);
+		reader.read(pulse.duty);
+		reader.read(pulse.step);
+		reader.check(pulse.duty < 4 && pulse.step < 8, "Save state pulse sequencer is out of range");
+		reader.read(pulse.period);
+		reader.read(pulse.delay);
+		reader.read(pulse.length);
+		reader.read(pulse.sweepEnabled);
+		reader.read(pulse.sweepNegate);
+		reader.read(pulse.sweepReload);
+		reader.read(pulse.sweepPeriod);
+		reader.read(pulse.sweepShift);
+		reader.check(pulse.sweepShift < 8, "Save state pulse sweep is out of range");
+		reader.read(pulse.sweepDivider);
+	}
+
+	reader.read(m_triangle.control);
+	reader.read(m_triangle.linearReload);
+	reader.read(m_triangle.linearPeriod);
+	reader.read(m_triangle.linearCounter);
+	reader.read(m_triangle.step);
+	reader.check(m_triangle.step < 32, "Save state triangle step is out of range");
+	reader.read(m_triangle.period);
+	reader.read(m_triangle.delay);
+	reader.read(m_triangle.length);
+
+	reader.read(m_noise.envelope.start);
+	reader.read(m_noise.envelope.loop);
+	reader.read(m_noise.envelope.constant);
+	reader.read(m_noise.envelope.period);
+	reader.read(m_noise.envelope.divider);
+	reader.read(m_noise.envelope.decay);
+	reader.read(m_noise.shortMode);
+	reader.read(m_noise.shift);
+	reader.read(m_noise.period);
+	reader.check(std::find(std::begin(noiseTable), std::end(noiseTable), m_noise.period) != std::end(noiseTable),
+		"Save state noise period is out of range");
+	reader.read(m_noise.delay);
+	reader.read(m_noise.length);
+
+	reader.read(m_dmc.irqEnabled);
+	reader.read(m_dmc.loop);
+	reader.read(m_dmc.irq);
+	reader.read(m_dmc.period);
+	reader.check(std::find(std::begin(dmcTable), std::end(dmcTable), m_dmc.period) != std::end(dmcTable),
+		"Save state DMC period is out of range");
+	reader.read(m_dmc.delay);
+	reader.read(m_dmc.level);
+	reader.read(m_dmc.sampleAddress);
+	reader.read(m_dmc.sampleLength);
+	reader.read(m_dmc.address);
+	reader.read(m_dmc.bytesRemaining);
+	reader.read(m_dmc.buffer);
+	reader.read(m_dmc.bufferFull);
+	reader.read(m_dmc.shifter);
+	reader.read(m_dmc.bitsRemaining);
+	reader.check(m_dmc.bitsRemaining >= 1 && m_dmc.bitsRemaining <= 8, "Save state DMC bit count is out of range");
+	reader.read(m_dmc.silence);
+
+	reader.read(m_enabled);
+	reader.read(m_fiveStep);
+	reader.read(m_irqInhibit);
+	reader.read(m_frameIrq);
+	reader.read(m_frameCycle);
+	reader.read(m_frameStep);
+	reader.check(m_frameStep < 4, "Save state frame counter step is out of range");
+	reader.check(m_frameCycle >= -1 && m_frameCycle <= frameSteps[m_fiveStep][m_frameStep],
+		"Save state frame counter cycle is out of range");
+
+	uint64_t stallCycles = 0;
+	reader.read(m_cycle);
+	reader.read(stallCycles);
+	m_stallCycles = (size_t)stallCycles;
+	reader.check(m_stallCycles <= 0xFFFF, "Save state DMC stall is out of range");
+
+	// The outputs pick up their levels on the next run
+	m_frameStart = m_cycle;
+	if (m_buffer != nullptr)
+		m_buffer->clear();
+
+	for (Output* output : { &m_pulseOutput[0], &m_pulseOutput[1],
+		&m_triangleOutput, &m_noiseOutput, &m_dmcOutput })
+		output->level = 0;
+}
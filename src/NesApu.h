@@ -1 +1,189 @@
 #pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <functional>
+
+#include "IBusSlave.h"
+#include "NesBlipBuffer.h"
+
+
+// The 2A03's audio unit: two pulse channels, triangle, noise, DMC and
+// the frame counter. Its registers are at $4000-$4013, $4015 and $4017.
+//
+// The APU runs behind the CPU and is caught up to a CPU cycle with run(),
+// which the system does before register accesses and whenever the APU
+// needs the CPU (cyclesUntilEvent): the frame IRQ and DMC sample fetches,
+// which steal CPU cycles (takeStallCycles). Channels are stepped from one
+// change of their output to the next, never per cycle, and the changes
+// go into a band-limited step buffer that samples are read from. Channels
+// are mixed linearly (the usual approximation of the nonlinear DAC).
+class NesApu final : public IBusSlave<uint16_t, uint8_t> {
+public:
+	typedef std::function<uint8_t(uint16_t address)> MemoryReader;
+
+	// NTSC CPU clock
+	static const size_t clockRate = 1789773;
+
+	NesApu(MemoryReader readMemory);
+
+	void reset(size_t cycle);
+
+	// Runs everything up to the given CPU cycle
+	void run(size_t cycle);
+	size_t getCycle() const { return (size_t)m_cycle; }
+
+	// CPU cycles from the last run until the frame IRQ or the
+	// next DMC fetch, SIZE_MAX if neither is coming
+	size_t cyclesUntilEvent() const;
+
+	bool getIrq() const { return m_frameIrq || m_dmc.irq; }
+
+	// Cycles the DMC's fetches halted the CPU for since last asked
+	size_t takeStallCycles();
+
+	// Samples are mono 16 bit, a rate of 0 turns synthesis off
+	// (the channels still run, only nothing is output)
+	void setSampleRate(size_t sampleRate);
+	void setRateRatio(double ratio);
+	size_t samplesAvailable() const;
+	size_t readSamples(int16_t* buffer, size_t maxSamples);
+
+
+	// From IBusSlave
+	inline const uint16_t size() override { return 0x18; }
+	uint8_t read(uint16_t address, bool readOnly = false) override;
+	void write(uint16_t address, uint8_t data) override;
+
+	void serialize(StateWriter& writer) override;
+	void deserialize(StateReader& reader) override;
+	// --------------
+
+private:
+	// Output level of a channel, turned into deltas for the buffer
+	struct Output {
+		int32_t weight = 0;
+		int32_t level = 0;
+	};
+
+	struct Envelope {
+		bool start = false;
+		bool loop = false;			// Also the length counter halt
+		bool constant = false;
+		uint8_t period = 0;			// Also the constant volume
+		uint8_t divider = 0;
+		uint8_t decay = 0;
+	};
+
+	struct Pulse {
+		Envelope envelope;
+		uint8_t duty = 0;
+		uint8_t step = 0;
+
+		uint16_t period = 0;
+		uint32_t delay = 0;			// Cycles until the timer next clocks
+		uint8_t length = 0;
+
+		bool sweepEnabled = false;
+		bool sweepNegate = false;
+		bool sweepReload = false;
+		uint8_t sweepPeriod = 0;
+		uint8_t sweepShift = 0;
+		uint8_t sweepDivider = 0;
+	};
+
+	struct Triangle {
+		bool control = false;		// Also the length counter halt
+		bool linearReload = false;
+		uint8_t linearPeriod = 0;
+		uint8_t linearCounter = 0;
+		uint8_t step = 0;
+
+		uint16_t period = 0;
+		uint32_t delay = 0;
+		uint8_t length = 0;
+	};
+
+	struct Noise {
+		Envelope envelope;
+		bool shortMode = false;
+		uint16_t shift = 0x0001;
+
+		uint16_t period = 0;
+		uint32_t delay = 0;
+		uint8_t length = 0;
+	};
+
+	struct Dmc {
+		bool irqEnabled = false;
+		bool loop = false;
+		bool irq = false;
+		uint16_t period = 0;
+		uint32_t delay = 0;
+		uint8_t level = 0;
+
+		uint16_t sampleAddress = 0xC000;
+		uint16_t sampleLength = 1;
+		uint16_t address = 0xC000;
+		uint16_t bytesRemaining = 0;
+
+		uint8_t buffer = 0;
+		bool bufferFull = false;
+
+		uint8_t shifter = 0;
+		uint8_t bitsRemaining = 8;
+		bool silence = true;
+	};
+
+	// Channels from the current time to end, times are in
+	// CPU cycles since the start of the buffer's frame
+	void m_runPulse(Pulse& pulse, Output& output, bool second, uint32_t start, uint32_t end);
+	void m_runTriangle(uint32_t start, uint32_t end);
+	void m_runNoise(uint32_t start, uint32_t end);
+	void m_runDmc(uint32_t start, uint32_t end);
+
+	void m_update(Output& output, uint32_t time, int32_t level);
+
+	// Frame counter
+	void m_clockFrameCounter();
+	void m_quarterFrame();
+	void m_halfFrame();
+	void m_clockEnvelope(Envelope& envelope);
+	void m_clockSweep(Pulse& pulse, bool second);
+
+	uint8_t m_volume(const Envelope& envelope) const;
+	uint16_t m_sweepTarget(const Pulse& pulse, bool second) const;
+	bool m_pulseMuted(const Pulse& pulse, bool second) const;
+
+	void m_restartDmc();
+	void m_fetchDmc();
+
+private:
+	MemoryReader m_readMemory;
+	std::unique_ptr<NesBlipBuffer> m_buffer;
+
+	Pulse m_pulse[2];
+	Triangle m_triangle;
+	Noise m_noise;
+	Dmc m_dmc;
+
+	Output m_pulseOutput[2];
+	Output m_triangleOutput;
+	Output m_noiseOutput;
+	Output m_dmcOutput;
+
+	// Status ($4015) enables, pulse 1 and 2, triangle, noise
+	uint8_t m_enabled = 0x00;
+
+	// Frame counter ($4017), in CPU cycles since its sequence started
+	bool m_fiveStep = false;
+	bool m_irqInhibit = false;
+	bool m_frameIrq = false;
+	int32_t m_frameCycle = 0;
+	uint8_t m_frameStep = 0;
+
+	uint64_t m_cycle = 0;		// Last cycle run to
+	uint64_t m_frameStart = 0;	// Cycle the buffer's frame started at
+	size_t m_stallCycles = 0;
+};
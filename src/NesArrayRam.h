@@ -27,6 +27,29 @@ public:
 		m_data[address % m_size] = data;
 	}
 
+	bool directMemory(uint16_t pageAddress, uint8_t*& data,
+		uint16_t& mask, bool& writable) override {
+		// Mirroring can only be expressed as a mask for power of two sizes
+		if (m_size == 0 || (m_size & (m_size - 1)) != 0)
+			return false;
+
+		data = m_data;
+		mask = m_size - 1;
+		writable = true;
+
+		return true;
+	}
+
+	void serialize(StateWriter& writer) override {
+		writer.write(m_size);
+		writer.write(m_data, m_size);
+	}
+
+	void deserialize(StateReader& reader) override {
+		reader.expect(m_size, "Save state RAM size doesn't match");
+		reader.read(m_data, m_size);
+	}
+
 private:
 	uint8_t* m_data;
 	uint16_t m_size;
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "NesAudioRing.h"
+
+
+NesAudioRing::NesAudioRing(size_t sampleRate, size_t latencyMs, bool paceProducer)
+	: m_sampleRate(sampleRate), m_paceProducer(paceProducer) {
+
+	m_target = std::max<size_t>(sampleRate * latencyMs / 1000, 1);
+
+	// A power of two so positions wrap with a mask
+	size_t capacity = 1;
+	while (capacity < m_target * 2)
+		capacity <<= 1;
+
+	m_samples.assign(capacity, 0);
+	m_mask = capacity - 1;
+}
+
+
+void NesAudioRing::samplesReady(const int16_t* samples, size_t count) {
+	// Producers nothing else paces wait while they're this far ahead
+	if (m_paceProducer) {
+		auto start = std::chrono::steady_clock::now();
+		while (fill() > m_target
+			&& std::chrono::steady_clock::now() - start < std::chrono::milliseconds(maxWaitMs))
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	// Steer the next frame's rate by how far from the target the ring is
+	double error = ((double)m_target - (double)fill()) / (double)m_target;
+	m_rateRatio = 1.0 + std::min(std::max(error, -1.0), 1.0) * maxRateDeviation;
+
+	size_t written = m_write(samples, count);
+	if (written < count)
+		m_dropped.fetch_add(count - written, std::memory_order_relaxed);
+}
+
+
+// The release store publishes the samples to the consumer's acquire load
+size_t NesAudioRing::m_write(const int16_t* samples, size_t count) {
+	size_t write = m_writePosition.load(std::memory_order_relaxed);
+	size_t read = m_readPosition.load(std::memory_order_acquire);
+
+	count = std::min(count, m_samples.size() - (write - read));
+
+	size_t offset = write & m_mask;
+	size_t first = std::min(count, m_samples.size() - offset);
+
+	std::memcpy(&m_samples[offset], samples, first * sizeof(int16_t));
+	std::memcpy(&m_samples[0], samples + first, (count - first) * sizeof(int16_t));
+
+	m_writePosition.store(write + count, std::memory_order_release);
+	return count;
+}
+
+
+void NesAudioRing::read(int16_t* samples, size_t count) {
+	size_t read = m_readPosition.load(std::memory_order_relaxed);
+	size_t write = m_writePosition.load(std::memory_order_acquire);
+
+	if (!m_playing) {
+		if (write - read < m_target) {
+			std::fill(samples, samples + count, m_lastSample);
+			return;
+		}
+
+		m_playing = true;
+	}
+
+	size_t available = std::min(count, write - read);
+
+	size_t offset = read & m_mask;
+	size_t first = std::min(available, m_samples.size() - offset);
+
+	std::memcpy(samples, &m_samples[offset], first * sizeof(int16_t));
+	std::memcpy(samples + first, &m_samples[0], (available - first) * sizeof(int16_t));
+
+	m_readPosition.store(read + available, std::memory_order_release);
+
+	if (available > 0)
+		m_lastSample = samples[available - 1];
+
+	if (available < count) {
+		std::fill(samples + available, samples + count, m_lastSample);
+		m_underruns.fetch_add(1, std::memory_order_relaxed);
+		m_playing = false;
+	}
+}
+
+
+size_t NesAudioRing::fill() const {
+	size_t read = m_readPosition.load(std::memory_order_acquire);
+	size_t write = m_writePosition.load(std::memory_order_acquire);
+
+	return write - read;
+}
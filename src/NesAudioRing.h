@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <atomic>
+
+#include "IAudioSink.h"
+
+
+// Lock-free single producer, single consumer ring of samples between the
+// emulation thread (the producer, through IAudioSink) and an audio device's
+// callback (the consumer, read()). The device never waits on the emulation.
+//
+// The device plays on its own clock, which drifts against the emulation's
+// (paced by video or the host timer). The ring keeps itself about half
+// full by asking for a slightly higher sample rate when it's emptier and a
+// lower one when it's fuller (dynamic rate control), at most +-0.5%, which
+// can't be heard. Samples that don't fit are dropped. A producer with
+// nothing else pacing it can have samplesReady wait instead, for the
+// device to play the ring down to half full.
+class NesAudioRing final : public IAudioSink {
+public:
+	// latencyMs is the fill the ring aims for, it holds twice that
+	NesAudioRing(size_t sampleRate, size_t latencyMs = 40, bool paceProducer = false);
+
+	NesAudioRing(const NesAudioRing&) = delete;
+	NesAudioRing& operator=(const NesAudioRing&) = delete;
+
+	// Producer side, from IAudioSink
+	size_t sampleRate() override { return m_sampleRate; }
+	void samplesReady(const int16_t* samples, size_t count) override;
+	double rateRatio() override { return m_rateRatio; }
+
+	// Consumer side, always fills the whole buffer. It's silent until the
+	// ring first fills up to the target (and again after an underrun, whose
+	// missing samples repeat the last one so it doesn't click).
+	void read(int16_t* samples, size_t count);
+
+	// Either side
+	size_t fill() const;
+	size_t capacity() const { return m_samples.size(); }
+	size_t target() const { return m_target; }
+	size_t underruns() const { return m_underruns.load(std::memory_order_relaxed); }
+	size_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+	// Furthest the rate is scaled either way
+	static constexpr double maxRateDeviation = 0.005;
+
+	// Longest a paced producer waits for the consumer before dropping samples
+	static constexpr size_t maxWaitMs = 100;
+
+private:
+	size_t m_write(const int16_t* samples, size_t count);
+
+private:
+	size_t m_sampleRate;
+	size_t m_target;
+	size_t m_mask;
+	bool m_paceProducer;
+	std::vector<int16_t> m_samples;
+
+	// Only touched by the producer
+	double m_rateRatio = 1.0;
+
+	// Only touched by the consumer
+	int16_t m_lastSample = 0;
+	bool m_playing = false;
+
+	// Positions count up forever, each side only writes its own. Kept on
+	// separate cache lines so the sides don't invalidate each other's.
+	alignas(64) std::atomic<size_t> m_writePosition{ 0 };
+	alignas(64) std::atomic<size_t> m_readPosition{ 0 };
+
+	std::atomic<size_t> m_underruns{ 0 };
+	std::atomic<size_t> m_dropped{ 0 };
+};
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "NesBlipBuffer.h"
+
+
+NesBlipBuffer::NesBlipBuffer(double clockRate, double sampleRate, uint32_t maxFrame, size_t bufferMs) {
+	m_baseFactor = sampleRate / clockRate * 4294967296.0;
+	m_factor = (uint64_t)(m_baseFactor + 0.5);
+	m_capacity = (size_t)(sampleRate * bufferMs / 1000) + 1;
+
+	// A full buffer still takes a whole frame before the oldest are dropped
+	size_t frameSamples = (size_t)(maxFrame * m_baseFactor * (1.0 + maxRatio) / 4294967296.0) + 1;
+	m_buffer.assign(m_capacity + frameSamples + width, 0);
+
+	const double pi = 3.14159265358979323846;
+
+	// A little below Nyquist so the window's roll-off doesn't alias
+	const double cutoff = 0.9;
+
+	for (int phase = 0; phase < phases; phase++) {
+		double taps[width];
+		double sum = 0.0;
+
+		// Centered between taps 7 and 8, moved right by the phase
+		for (int tap = 0; tap < width; tap++) {
+			double x = tap - (width / 2 - 1) - (double)phase / phases;
+			double sinc = (x == 0.0) ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+			double window = 0.42 + 0.5 * std::cos(2.0 * pi * x / width)
+				+ 0.08 * std::cos(4.0 * pi * x / width);
+
+			taps[tap] = sinc * window;
+			sum += taps[tap];
+		}
+
+		// Every phase has to sum to exactly one step
+		int32_t total = 0;
+		for (int tap = 0; tap < width; tap++) {
+			m_kernel[phase][tap] = (int32_t)std::lround(taps[tap] / sum * (1 << kernelBits));
+			total += m_kernel[phase][tap];
+		}
+
+		m_kernel[phase][width / 2 - 1] += (1 << kernelBits) - total;
+	}
+}
+
+
+// Positions are in samples, so the frames before keep theirs
+void NesBlipBuffer::setRatio(double ratio) {
+	ratio = std::min(std::max(ratio, 1.0 - maxRatio), 1.0 + maxRatio);
+	m_factor = (uint64_t)(m_baseFactor * ratio + 0.5);
+}
+
+
+void NesBlipBuffer::endFrame(uint32_t clocks) {
+	m_offset += clocks * m_factor;
+
+	// Nobody is reading, keep the newest. The dropped steps still
+	// go through the integrator so the level carries on from them.
+	size_t available = samplesAvailable();
+	if (available > m_capacity) {
+		size_t count = available - m_capacity;
+
+		for (size_t sample = 0; sample < count; sample++) {
+			m_integrator += m_buffer[sample];
+			m_integrator -= m_integrator >> bassShift;
+		}
+
+		m_removeSamples(count);
+	}
+}
+
+
+size_t NesBlipBuffer::readSamples(int16_t* out, size_t count) {
+	count = std::min(count, samplesAvailable());
+
+	int32_t integrator = m_integrator;
+
+	for (size_t sample = 0; sample < count; sample++) {
+		integrator += m_buffer[sample];
+
+		int32_t value = integrator >> kernelBits;
+		out[sample] = (int16_t)std::min(std::max(value, -32768), 32767);
+
+		integrator -= integrator >> bassShift;
+	}
+
+	m_integrator = integrator;
+	m_removeSamples(count);
+
+	return count;
+}
+
+
+void NesBlipBuffer::clear() {
+	std::fill(m_buffer.begin(), m_buffer.end(), 0);
+	m_offset = 0;
+	m_integrator = 0;
+}
+
+
+// Moves what's left (including the tails of steps
+// past the frame's end) to the front
+void NesBlipBuffer::m_removeSamples(size_t count) {
+	size_t remaining = samplesAvailable() + width - count;
+
+	std::memmove(m_buffer.data(), m_buffer.data() + count, remaining * sizeof(int32_t));
+	std::fill(m_buffer.begin() + remaining, m_buffer.end(), 0);
+
+	m_offset -= (uint64_t)count << fractionBits;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+
+// Band-limited synthesis in the style of blargg's Blip_Buffer. Sources
+// don't produce samples, they add the steps of their output (deltas) at
+// the clock they happen. Each step is spread over a few samples as a
+// band-limited step (a windowed sinc picked by the step's fraction of a
+// sample), so a channel costs one add per change instead of per clock and
+// there is no aliasing from sampling a square wave. Reading integrates the
+// steps back into a waveform and filters out the DC.
+class NesBlipBuffer final {
+public:
+	// Holds up to bufferMs of samples, older ones are dropped. Frames
+	// may be at most maxFrame clocks long.
+	NesBlipBuffer(double clockRate, double sampleRate, uint32_t maxFrame, size_t bufferMs = 250);
+
+	// Time is in clocks since the start of the current frame
+	inline void addDelta(uint32_t time, int32_t delta) {
+		uint64_t position = m_offset + time * m_factor;
+		const int32_t* kernel = m_kernel[(position >> (fractionBits - phaseBits)) & (phases - 1)];
+		int32_t* out = &m_buffer[(size_t)(position >> fractionBits)];
+
+		for (int tap = 0; tap < width; tap++)
+			out[tap] += kernel[tap] * delta;
+	}
+
+	// Ends the frame after the given number of clocks, the
+	// samples up to its end can be read from then on
+	void endFrame(uint32_t clocks);
+
+	// Scales the sample rate from the next frame on, by at most
+	// maxRatio either way (rate control against an audio device)
+	void setRatio(double ratio);
+	static constexpr double maxRatio = 0.01;
+
+	size_t samplesAvailable() const { return (size_t)(m_offset >> fractionBits); }
+	size_t readSamples(int16_t* out, size_t count);
+	void clear();
+
+private:
+	void m_removeSamples(size_t count);
+
+private:
+	// Taps per step and steps per sample it can start at
+	static const int width = 16;
+	static const int phaseBits = 5;
+	static const int phases = 1 << phaseBits;
+
+	// The kernel sums to 1 << kernelBits, positions are 32.32 samples
+	static const int kernelBits = 12;
+	static const int fractionBits = 32;
+
+	// Integrator leak, a high-pass at about 15 Hz at 48 kHz
+	static const int bassShift = 9;
+
+	int32_t m_kernel[phases][width];
+
+	uint64_t m_factor;		// Samples per clock
+	double m_baseFactor;	// Before setRatio()
+	uint64_t m_offset = 0;	// Start of the frame in samples
+	size_t m_capacity;
+
+	std::vector<int32_t> m_buffer;
+	int32_t m_integrator = 0;
+};
@@ -7,56 +7,45 @@
 #include "Mapper_002.h"
 
 
-NesCartridge::NesCartridge(const char* romFilePath) {
-	std::ifstream romFile;
-	romFile.open(romFilePath, std::ifstream::binary | std::ifstream::in);
+NesCartridge::NesCartridge(const char* romFilePath) : NesCartridge(loadImage(romFilePath)) {}
 
-	if (!romFile.is_open()) {
-		fmt::print("Couldn't open ROM file!\n");
-		return;
-	}
 
-	// Read iNES file header
-	romFile.read((char*)&m_header, sizeof(romHeader));
+NesCartridge::NesCartridge(std::shared_ptr<const NesRomImage> image) : m_image(image) {
+	if (m_image == nullptr)
+		return;
 
-	// Read training information, ignored for now
-	// TODO: Read it
-	if (m_header.mapper1 & 0x04)
-		romFile.seekg(512, std::ios_base::cur);
+	m_header = m_image->header;
 
 	// Set mapper information
 	m_mapperID = ((m_header.mapper2 >> 4) << 4 | (m_header.mapper1 >> 4));
 
-	// Get type of iNES file
-	// TODO: Do this instead of hard coding 1
-	m_fileType = 1;
-
-	// TODO: Implement more file type handlers
-	switch (m_fileType) {
-	case 0:
-		fmt::print("iNES file type 0 not implemented!\n");
-		return;
-	case 1:
-		// Read PRG memory
-		m_PRGBanks = m_header.prg_rom_chunks;
-		m_PRGMemorySize = (uint16_t)m_PRGBanks * 16384;
-		m_PRGMemory = new uint8_t[m_PRGMemorySize];
-		romFile.read((char*)m_PRGMemory, m_PRGMemorySize);
-
-		// Read CHR memory
-		m_CHRBanks = m_header.chr_rom_chunks;
-		m_CHRMemorySize = (uint16_t)m_CHRBanks * 8192;
-		m_CHRMemory = new uint8_t[m_CHRMemorySize];
-		romFile.read((char*)m_CHRMemory, m_CHRMemorySize);
-		break;
-	case 2:
-		fmt::print("iNES file type 2 not implemented!\n");
-		return;
-	default:
-		fmt::print("Unsuported iNES file type!\n");
+	// ROM is never written (mappers don't map writes to it), so
+	// cartridges can point into the shared image
+	m_PRGBanks = m_header.prg_rom_chunks;
+	if (m_PRGBanks == 0) {
+		fmt::print("Cartridge has no PRG ROM!\n");
 		return;
 	}
 
+	m_PRGMemorySize = (uint32_t)m_image->prg.size();
+	m_PRGMemory = const_cast<uint8_t*>(m_image->prg.data());
+
+	// Without CHR ROM the cartridge has 8KB of CHR RAM of its own
+	m_CHRBanks = m_header.chr_rom_chunks;
+	if (m_CHRBanks == 0) {
+		m_CHRRam.assign(8192, 0);
+		m_CHRMemorySize = (uint32_t)m_CHRRam.size();
+		m_CHRMemory = m_CHRRam.data();
+
+		m_CHRRamTiles = std::make_unique<NesTileCache>(m_CHRMemory, m_CHRMemorySize, true);
+		m_tileCache = m_CHRRamTiles.get();
+	}
+	else {
+		m_CHRMemorySize = (uint32_t)m_image->chr.size();
+		m_CHRMemory = const_cast<uint8_t*>(m_image->chr.data());
+		m_tileCache = m_image->chrTiles.get();
+	}
+
 	// Load appropriate mapper
 	switch (m_mapperID) {
 	case 0:
@@ -80,16 +69,74 @@ NesCartridge::NesCartridge(const char* romFilePath) {
 	}
 
 	m_isLoaded = true;
-	romFile.close();
 }
 
 
-NesCartridge::~NesCartridge() {
-	if (m_PRGMemory != nullptr)
-		delete[] m_PRGMemory;
+NesCartridge::~NesCartridge() {}
+
+
+std::shared_ptr<const NesRomImage> NesCartridge::loadImage(const char* romFilePath) {
+	std::ifstream romFile;
+	romFile.open(romFilePath, std::ifstream::binary | std::ifstream::in);
+
+	if (!romFile.is_open()) {
+		fmt::print("Couldn't open ROM file!\n");
+		return nullptr;
+	}
+
+	std::shared_ptr<NesRomImage> image = std::make_shared<NesRomImage>();
+
+	// Read iNES file header
+	romFile.read((char*)&image->header, sizeof(romHeader));
+
+	// Read training information, ignored for now
+	// TODO: Read it
+	if (image->header.mapper1 & 0x04)
+		romFile.seekg(512, std::ios_base::cur);
 
-	if (m_CHRMemory != nullptr)
-		delete[] m_CHRMemory;
+	// Get type of iNES file
+	// TODO: Do this instead of hard coding 1
+	uint8_t fileType = 1;
+
+	// TODO: Implement more file type handlers
+	switch (fileType) {
+	case 0:
+		fmt::print("iNES file type 0 not implemented!\n");
+		return nullptr;
+	case 1:
+		// Read PRG memory
+		image->prg.resize((size_t)image->header.prg_rom_chunks * 16384);
+		romFile.read((char*)image->prg.data(), image->prg.size());
+
+		// Read CHR memory, there's none with CHR RAM
+		image->chr.resize((size_t)image->header.chr_rom_chunks * 8192);
+		romFile.read((char*)image->chr.data(), image->chr.size());
+
+		// ROM tiles never go stale, so cartridges share them
+		if (!image->chr.empty())
+			image->chrTiles = std::make_unique<NesTileCache>(image->chr.data(), (uint32_t)image->chr.size(), false);
+		break;
+	case 2:
+		fmt::print("iNES file type 2 not implemented!\n");
+		return nullptr;
+	default:
+		fmt::print("Unsuported iNES file type!\n");
+		return nullptr;
+	}
+
+	image->hash = m_hash(0xCBF29CE484222325, (const uint8_t*)&image->header, sizeof(romHeader));
+	image->hash = m_hash(image->hash, image->prg.data(), image->prg.size());
+	image->hash = m_hash(image->hash, image->chr.data(), image->chr.size());
+
+	return image;
+}
+
+
+uint64_t NesCartridge::m_hash(uint64_t hash, const uint8_t* data, size_t size) {
+	for (size_t byte = 0; byte < size; byte++)
+		hash = (hash ^ data[byte]) * 0x100000001B3;
+
+	return hash;
 }
 
 
@@ -105,13 +152,57 @@ uint8_t NesCartridge::read(uint16_t address, bool readOnly) {
 
 
 void NesCartridge::write(uint16_t address, uint8_t data) {
+	uint32_t bankVersion = m_mapper->getBankVersion();
+	uint32_t mappedAddress = m_mapper->mapWrite(address, data);
+
+	// Mapper registers can switch CHR banks
+	if (m_mapper->getBankVersion() != bankVersion)
+		m_tileVersion++;
+
+	if (mappedAddress == IMapper::unmapped)
+		return;
+
 	// PPU Write
-	if (address >= 0x0000 && address <= 0x1FFF)
-		m_PRGMemory[m_mapper->mapWrite(address)] = data;
+	if (address >= 0x0000 && address <= 0x1FFF) {
+		m_CHRMemory[mappedAddress] = data;
+		m_tileCache->invalidate(mappedAddress);
+		m_tileVersion++;
+	}
 
 	// CPU Write
 	if (address >= 0x8000 && address <= 0xFFFF)
-		m_CHRMemory[m_mapper->mapWrite(address)] = data;
+		m_PRGMemory[mappedAddress] = data;
+}
+
+
+// Mappers switch whole banks, so a page is contiguous in the bank
+// it is currently mapped to. Writes go to the mapper.
+bool NesCartridge::directMemory(uint16_t pageAddress, uint8_t*& data,
+	uint16_t& mask, bool& writable) {
+
+	if (!m_isLoaded)
+		return false;
+
+	// PPU Page
+	if (pageAddress >= 0x0000 && pageAddress <= 0x1FFF && m_CHRMemorySize > 0)
+		data = m_CHRMemory + m_mapper->mapRead(pageAddress);
+
+	// CPU Page
+	else if (pageAddress >= 0x8000 && pageAddress <= 0xFFFF)
+		data = m_PRGMemory + m_mapper->mapRead(pageAddress);
+
+	else
+		return false;
+
+	mask = 0x00FF;
+	writable = false;
+
+	return true;
+}
+
+
+uint64_t NesCartridge::tileRow(uint16_t address) {
+	return m_tileCache->row(m_mapper->mapRead(address));
 }
 
 
@@ -124,3 +215,27 @@ inline const uint16_t NesCartridge::size() {
 MIRROR_MODE NesCartridge::getMirorMode() {
 	return m_mirrorMode;
 }
+
+
+// ROM is part of the file, only the mapper's
+// registers and CHR RAM (no CHR banks) are saved
+void NesCartridge::serialize(StateWriter& writer) {
+	m_mapper->serialize(writer);
+
+	if (m_CHRBanks == 0) {
+		writer.write(m_CHRMemorySize);
+		writer.write(m_CHRMemory, m_CHRMemorySize);
+	}
+}
+
+
+void NesCartridge::deserialize(StateReader& reader) {
+	m_mapper->deserialize(reader);
+	m_tileVersion++;
+
+	if (m_CHRBanks == 0) {
+		reader.expect(m_CHRMemorySize, "Save state CHR RAM size doesn't match");
+		reader.read(m_CHRMemory, m_CHRMemorySize);
+		m_tileCache->invalidateAll();
+	}
+}
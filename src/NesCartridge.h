@@ -1,40 +1,73 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <vector>
 
 #include "IBusSlave.h"
+#include "ITileSource.h"
 #include "NesRom.h"
+#include "NesTileCache.h"
 
 #include "IMapper.h"
 
 
-class NesCartridge : public IBusSlave<uint16_t, uint8_t> {
+class NesCartridge : public IBusSlave<uint16_t, uint8_t>, public ITileSource {
 public:
 	NesCartridge(const char* romFilePath);
+	NesCartridge(std::shared_ptr<const NesRomImage> image);
 	~NesCartridge();
 
+	// Reads a ROM file once so several cartridges can be made from it,
+	// returns nullptr if the file can't be read
+	static std::shared_ptr<const NesRomImage> loadImage(const char* romFilePath);
+
 	bool inline isLoaded() const { return m_isLoaded; }
 	MIRROR_MODE getMirorMode();
 
+	// FNV-1a of the header and the PRG and CHR ROM, tells dumps apart
+	uint64_t getRomHash() const { return m_image ? m_image->hash : 0; }
+
 	// From IBusSlave
 	inline const uint16_t size() override;
 	uint8_t read(uint16_t address, bool readOnly) override;
 	void write(uint16_t address, uint8_t data) override;
+	bool directMemory(uint16_t pageAddress, uint8_t*& data,
+		uint16_t& mask, bool& writable) override;
+	uint32_t mappingVersion() override { return m_mapper->getBankVersion(); }
+
+	void serialize(StateWriter& writer) override;
+	void deserialize(StateReader& reader) override;
+	// --------------
+
+	// From ITileSource
+	uint64_t tileRow(uint16_t address) override;
+	uint32_t tileVersion() override { return m_tileVersion; }
 	// --------------
 
+private:
+	static uint64_t m_hash(uint64_t hash, const uint8_t* data, size_t size);
+
 private:
 	bool m_isLoaded = false;
 
 	std::shared_ptr<IMapper> m_mapper;
 	MIRROR_MODE m_mirrorMode;
 	romHeader m_header;
-	uint8_t m_fileType = 0;
+	std::shared_ptr<const NesRomImage> m_image;
 
+	// Point into the image, except CHR RAM which every cartridge owns
 	uint8_t* m_PRGMemory = nullptr;
-	uint16_t m_PRGMemorySize = 0;
+	uint32_t m_PRGMemorySize = 0;
 
 	uint8_t* m_CHRMemory = nullptr;
-	uint16_t m_CHRMemorySize = 0;
+	uint32_t m_CHRMemorySize = 0;
+	std::vector<uint8_t> m_CHRRam;
+	std::unique_ptr<NesTileCache> m_CHRRamTiles;
+
+	// The image's for CHR ROM, m_CHRRamTiles for CHR RAM
+	NesTileCache* m_tileCache = nullptr;
+	uint32_t m_tileVersion = 0;
 
 	uint8_t m_mapperID = 0;
 	uint8_t m_PRGBanks = 0;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "IBusSlave.h"
+
+
+// The two standard controllers at $4016 (port 1) and $4017 (port 2).
+// While bit 0 of the last $4016 write (strobe) is set, both shift
+// registers keep reloading from the buttons held, and they hold what they
+// had when it's cleared. Each read then returns the port's next button in
+// bit 0, A first and Right last, and 1s once all 8 were read. The upper
+// bits are open bus, the $40 of the address the CPU just put out.
+class NesControllers final : public IBusSlave<uint16_t, uint8_t> {
+public:
+	// Bit 0 is A, then B, Select, Start, Up, Down, Left and Right
+	void setButtons(size_t port, uint8_t buttons) { m_buttons[port & 0x01] = buttons; }
+	uint8_t getButtons(size_t port) const { return m_buttons[port & 0x01]; }
+
+	inline const uint16_t size() override {
+		return 2;
+	}
+
+	uint8_t read(uint16_t address, bool readOnly = false) override {
+		uint8_t& shift = m_shift[address & 0x01];
+
+		if (m_strobe)
+			m_reload();
+
+		uint8_t bit = shift & 0x01;
+
+		// Debug reads don't move on to the next button
+		if (!readOnly && !m_strobe)
+			shift = (shift >> 1) | 0x80;
+
+		return 0x40 | bit;
+	}
+
+	void write(uint16_t address, uint8_t data) override {
+		// The registers latch the buttons as the strobe goes low too
+		if (m_strobe || (data & 0x01))
+			m_reload();
+
+		m_strobe = data & 0x01;
+	}
+
+	void serialize(StateWriter& writer) override {
+		writer.write(m_buttons, sizeof(m_buttons));
+		writer.write(m_shift, sizeof(m_shift));
+		writer.write(m_strobe);
+	}
+
+	void deserialize(StateReader& reader) override {
+		reader.read(m_buttons, sizeof(m_buttons));
+		reader.read(m_shift, sizeof(m_shift));
+		reader.read(m_strobe);
+	}
+
+private:
+	inline void m_reload() {
+		m_shift[0] = m_buttons[0];
+		m_shift[1] = m_buttons[1];
+	}
+
+private:
+	uint8_t m_buttons[2] = {};
+	uint8_t m_shift[2] = {};
+	uint8_t m_strobe = 0;
+};
@@ -1,20 +1,26 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <atomic>
 
 #include "fmt/printf.h"
 
 #include "NesCore.h"
 #include "NesCartridge.h"
 #include "Config.h"
+#include "NesAudioRing.h"
 
 
-NesCore::NesCore(
-	std::shared_ptr<INesCpu> cpu,
-	std::shared_ptr<INesPpu> ppu,
+template <typename cpuType, typename busType, typename ppuType>
+NesSystem<cpuType, busType, ppuType>::NesSystem(
+	std::shared_ptr<cpuType> cpu,
+	std::shared_ptr<ppuType> ppu,
 	std::shared_ptr<IRam<uint16_t, uint8_t>> ram,
-	std::shared_ptr<IBus<uint16_t, uint8_t>> cpuBus,
-	std::shared_ptr<IBus<uint16_t, uint8_t>> ppuBus
+	std::shared_ptr<busType> cpuBus,
+	std::shared_ptr<busType> ppuBus
 ) : m_cpu(cpu), m_ppu(ppu), m_ram(ram), m_cpuBus(cpuBus), m_ppuBus(ppuBus) {
 
 	m_totalCyclesPassed = 0;
@@ -25,8 +31,11 @@ NesCore::NesCore(
 	// Add the system RAM to the bus
 	m_cpuBus->mapSlave(m_ram, 0x0000, 0x17FF);
 
-	// Add the PPU to the CPU Bus
-	m_cpuBus->mapSlave(m_ppu, 0x2000, 0x3FFF);
+	// Add the PPU to the CPU Bus, behind a port that
+	// catches it up before the CPU touches its registers
+	m_cpuBus->mapSlave(std::make_shared<NesSyncSlave>(m_ppu,
+		[this](uint16_t address, bool write) { m_syncPpu(address, write); }),
+		0x2000, 0x3FFF);
 
 	// Connect PPU to its bus
 	m_ppu->connectBus(m_ppuBus);
@@ -42,8 +51,22 @@ NesCore::NesCore(
 
 	m_ppuBus->mapSlave(m_palletteRam, 0x3F00, 0x3FFF);
 
-	m_controller1 = std::make_shared<NesArrayRam>(0x2);
-	m_cpuBus->mapSlave(m_controller1, 0x4016);
+	m_controllers = std::make_shared<NesControllers>();
+	m_cpuBus->mapSlave(m_controllers, 0x4016, 0x4016);
+
+	// The APU runs behind the CPU too, its DMC reads samples over the CPU's bus
+	m_apu = std::make_shared<NesApu>([this](uint16_t address) { return m_cpuBus->read(address); });
+
+	auto apuPort = std::make_shared<NesSyncSlave>(m_apu,
+		[this](uint16_t address, bool write) { m_syncApu(address, write); });
+	m_cpuBus->mapSlave(apuPort, 0x4000, 0x4013);
+	m_cpuBus->mapSlave(apuPort, 0x4015, 0x4015);
+
+	// $4017 reads controller 2 but writes the APU's frame counter
+	m_cpuBus->mapSlave(std::make_shared<NesSplitSlave>(m_controllers, apuPort), 0x4017, 0x4017);
+
+	m_cpuBus->mapSlave(std::make_shared<NesOamDma>(
+		[this](uint8_t page) { m_oamDma(page); }), 0x4014);
 
 #ifdef _LOG
 	// Open debug file
@@ -55,7 +78,8 @@ NesCore::NesCore(
 }
 
 
-NesCore::~NesCore() {
+template <typename cpuType, typename busType, typename ppuType>
+NesSystem<cpuType, busType, ppuType>::~NesSystem() {
 #ifdef _LOG
 	if (m_cpuLogFile.is_open())
 		m_cpuLogFile.close();
@@ -63,14 +87,21 @@ NesCore::~NesCore() {
 }
 
 
-void NesCore::powerOn() {
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::powerOn() {
 	m_isOn = true;
 
 	reset();
 
 	if (m_realTime) {
-		while (m_isOn)
+		while (m_isOn) {
+#ifdef _LOG
+			// Traces are written per instruction by tick()
 			tick();
+#else
+			runFrame();
+#endif
+		}
 	}
 	else {
 		while (m_isOn) {
@@ -83,16 +114,28 @@ void NesCore::powerOn() {
 }
 
 
-void NesCore::reset() {
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::reset() {
 	m_totalCyclesPassed = 0;
+	m_cpuPhase = 0;
+	m_scheduler.clear();
 	m_cpu->reset();
 	m_ppu->reset();
+	m_apu->reset(m_cpu->getCyclesPassed());
+	m_runApu();
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+bool NesSystem<cpuType, busType, ppuType>::loadCartridge(const char* filePath) {
+	return loadCartridge(NesCartridge::loadImage(filePath));
 }
 
 
-bool NesCore::loadCartridge(const char* filePath) {
-	// Construct Cartridge (which also loads file into it)
-	m_cartridge = std::make_shared<NesCartridge>(filePath);
+template <typename cpuType, typename busType, typename ppuType>
+bool NesSystem<cpuType, busType, ppuType>::loadCartridge(std::shared_ptr<const NesRomImage> image) {
+	// Construct Cartridge on the (possibly shared) ROM image
+	m_cartridge = std::make_shared<NesCartridge>(image);
 
 	if (!m_cartridge->isLoaded()) {
 		fmt::print("Failed to load cartrigde!\n");
@@ -102,6 +145,7 @@ bool NesCore::loadCartridge(const char* filePath) {
 	// Connect Cartridge CPU and PPU
 	m_cpuBus->mapSlave(m_cartridge, 0x8000, 0xFFFF);
 	m_ppuBus->mapSlave(m_cartridge, 0x0000, 0x1FFF);
+	m_ppu->setTileSource(m_cartridge);
 
 	// Map Nametables based on the mirroring
 	// mode of the cartridge
@@ -116,7 +160,7 @@ bool NesCore::loadCartridge(const char* filePath) {
 		break;
 	case MIRROR_MODE::HORIZONTAL:
 		m_ppuBus->mapSlave(m_nameTable0, 0x2000, 0x27FF);
-		m_ppuBus->mapSlave(m_nameTable1, 0x8000, 0x2FFF);
+		m_ppuBus->mapSlave(m_nameTable1, 0x2800, 0x2FFF);
 		break;
 	case MIRROR_MODE::ONE_SCREEN:
 		m_ppuBus->mapSlave(m_nameTable0, 0x2000, 0x2FFF);
@@ -135,8 +179,9 @@ bool NesCore::loadCartridge(const char* filePath) {
 }
 
 
-void NesCore::tick() {
-	if (m_totalCyclesPassed % 3 == 0) {
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::tick() {
+	if (m_cpuPhase == 0) {
 #ifdef _LOG
 		std::string line = m_cpu->getLog();
 
@@ -149,19 +194,21 @@ void NesCore::tick() {
 		}
 #endif
 		m_cpu->tick();
+		m_updateApu();
 	}
 
 	// PPU clocks 3 times faster than the CPU
-	m_ppu->tick();
+	if (++m_cpuPhase == 3)
+		m_cpuPhase = 0;
 
-	// Interrupt CPU if needed
-	if (m_ppu->getNmi()) {
-		m_cpu->nmi();
-		m_ppu->clearNmi();
-	}
+	m_ppu->tick();
+	m_pollNmi();
 
 	m_totalCyclesPassed++;
 
+	if (m_rewind != nullptr && m_ppu->getFrameCount() != m_rewindFrame)
+		m_recordFrame();
+
 	// If some component isn't running
 	// stop the NES
 	if (!m_ppu->isRunning())
@@ -169,7 +216,255 @@ void NesCore::tick() {
 }
 
 
-void NesCore::powerOff() {
+// Runs the system for at least nCycles CPU cycles a whole instruction
+// at a time. In lockstep the PPU catches up after every instruction,
+// otherwise the CPU runs ahead up to the next scheduled event (or until
+// it touches the PPU's registers, see m_syncPpu) and the PPU catches up
+// once it stops.
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::runCycles(size_t nCycles) {
+	size_t targetCycle = m_cpu->getCyclesPassed() + nCycles;
+
+	m_ppuSyncCycle = m_cpu->getCyclesPassed();
+	m_catchingUp = (m_ppuSync == PPU_SYNC::CATCH_UP);
+
+	if (m_catchingUp)
+		m_scheduler.schedule(NES_EVENT::RUN_END, m_masterClock() + nCycles * NesScheduler::cpuCycle);
+
+	while (m_cpu->getCyclesPassed() < targetCycle) {
+		if (m_catchingUp) {
+			m_schedulePpuEvents();
+			m_scheduleApuEvent();
+
+			// Run up to the instruction the next event falls in
+			uint64_t now = m_masterClock();
+			uint64_t next = m_scheduler.next().time;
+			uint64_t wait = (next > now) ? next - now : 0;
+
+			m_cpu->runUntil(m_ppuSyncCycle + (wait + NesScheduler::cpuCycle - 1) / NesScheduler::cpuCycle);
+			m_catchUpPpu();
+			m_dispatchEvents();
+		}
+		else {
+			m_cpu->runCycles(1);
+			m_catchUpPpu();
+		}
+
+		m_updateApu();
+
+		if (m_rewind != nullptr && m_ppu->getFrameCount() != m_rewindFrame)
+			m_recordFrame();
+
+		// If some component isn't running
+		// stop the NES
+		if (!m_ppu->isRunning()) {
+			m_isOn = false;
+			break;
+		}
+	}
+
+	m_scheduler.cancel(NES_EVENT::RUN_END);
+	m_catchingUp = false;
+
+	// So the audio is there up to where the run ended
+	m_runApu();
+}
+
+
+// Runs until the PPU completes a frame
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::runFrame() {
+	if (m_movieMode != MOVIE_MODE::OFF)
+		m_movieFrame();
+
+	size_t frame = m_ppu->getFrameCount();
+
+	while (m_ppu->getFrameCount() == frame && m_ppu->isRunning())
+		runCycles((m_ppu->dotsUntilFrameEnd() + 3) / 3);
+
+	if (m_audioSink != nullptr)
+		m_pushAudio();
+}
+
+
+// Ticks the PPU up to the CPU's cycle count
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_catchUpPpu() {
+	size_t cycle = m_cpu->getCyclesPassed();
+
+	// PPU clocks 3 times faster than the CPU
+	size_t dots = (cycle - m_ppuSyncCycle) * 3;
+	m_ppuSyncCycle = cycle;
+
+	if (m_catchingUp) {
+		// NMI is only looked at when its event is due
+		for (size_t dot = 0; dot < dots; dot++)
+			m_ppu->tick();
+	}
+	else {
+		for (size_t dot = 0; dot < dots; dot++) {
+			m_ppu->tick();
+			m_pollNmi();
+		}
+	}
+
+	m_totalCyclesPassed += dots;
+}
+
+
+// The CPU is about to access a PPU register. Mid instruction its cycle
+// count is that of the instruction's start, which is where lockstep has
+// the PPU too, so both see the same PPU state.
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_syncPpu(uint16_t address, bool write) {
+	if (!m_catchingUp)
+		return;
+
+	m_catchUpPpu();
+
+	// Writing PPUCTRL may enable NMI in VBlank, which lockstep
+	// raises right after this instruction, so look at it then
+	if (write && (address & 0x0007) == 0x0000) {
+		m_scheduler.schedule(NES_EVENT::PPU_NMI, m_masterClock());
+		m_cpu->endRun();
+	}
+}
+
+
+// Copies a page of CPU memory to OAM, pages in host memory in one go.
+// The CPU is halted meanwhile for 513 cycles, plus one to get to an even
+// cycle. Writes to $4014 are STA/STX/STY absolute, 4 cycles, so the
+// parity of the instruction's start is that of the DMA's.
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_oamDma(uint8_t page) {
+	// OAM is PPU state, the PPU has to get to it first
+	if (m_catchingUp)
+		m_catchUpPpu();
+
+	const uint16_t address = page << 8;
+	const DirectPage<uint16_t, uint8_t>& direct = m_cpuBus->directPages()[page];
+
+	if (direct.data != nullptr && (direct.mask & 0x00FF) == 0x00FF) {
+		m_ppu->writeOam(direct.data + (address & direct.mask));
+	}
+	else {
+		uint8_t data[256];
+		for (size_t offset = 0; offset < 256; offset++)
+			data[offset] = m_cpuBus->read(address + offset);
+
+		m_ppu->writeOam(data);
+	}
+
+	m_cpu->stall(513 + (m_cpu->getCyclesPassed() & 1));
+}
+
+
+// The APU is run up to the CPU before the CPU touches its registers. A
+// read may acknowledge the IRQ and a write may start the DMC, so what it
+// needs from the CPU is looked at again once the instruction is done.
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_syncApu(uint16_t address, bool write) {
+	m_apu->run(m_cpu->getCyclesPassed());
+	m_apuTouched = true;
+
+	if (m_catchingUp)
+		m_cpu->endRun();
+}
+
+
+// Catches the APU up and hands the CPU what it wants: the cycles the
+// DMC's fetches took and the IRQ line
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_runApu() {
+	size_t cycle = m_cpu->getCyclesPassed();
+	m_apu->run(cycle);
+
+	size_t stall = m_apu->takeStallCycles();
+	if (stall > 0)
+		m_cpu->stall(stall);
+
+	m_cpu->setIrqLine(m_apu->getIrq());
+
+	m_apuEventCycle = cycle + std::min(m_apu->cyclesUntilEvent(), apuRunInterval);
+	m_apuTouched = false;
+}
+
+
+// Between instructions, both sync modes look at the APU at the same ones
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_updateApu() {
+	if (m_apuTouched || m_cpu->getCyclesPassed() >= m_apuEventCycle)
+		m_runApu();
+}
+
+
+// Predictions change whenever the PPU's registers are written,
+// so they're renewed before every run of the CPU
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_schedulePpuEvents() {
+	uint64_t now = m_masterClock();
+
+	// Events are due once the tick they happen in is done. Frames only
+	// matter to rewind, otherwise the CPU runs on past their ends.
+	if (m_rewind != nullptr)
+		m_scheduler.schedule(NES_EVENT::PPU_FRAME,
+			now + (m_ppu->dotsUntilFrameEnd() + 1) * NesScheduler::ppuDot);
+	else
+		m_scheduler.cancel(NES_EVENT::PPU_FRAME);
+
+	size_t nmiDots = m_ppu->dotsUntilNmi();
+	if (nmiDots != SIZE_MAX)
+		m_scheduler.schedule(NES_EVENT::PPU_NMI, now + (nmiDots + 1) * NesScheduler::ppuDot);
+	else
+		m_scheduler.cancel(NES_EVENT::PPU_NMI);
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_scheduleApuEvent() {
+	if (m_apuEventCycle == SIZE_MAX) {
+		m_scheduler.cancel(NES_EVENT::APU);
+		return;
+	}
+
+	size_t cycle = m_cpu->getCyclesPassed();
+	size_t until = (m_apuEventCycle > cycle) ? m_apuEventCycle - cycle : 0;
+
+	m_scheduler.schedule(NES_EVENT::APU, m_masterClock() + until * NesScheduler::cpuCycle);
+}
+
+
+// Handles the events that are due, always between instructions
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_dispatchEvents() {
+	uint64_t now = m_masterClock();
+
+	while (!m_scheduler.empty() && m_scheduler.next().time <= now) {
+		switch (m_scheduler.pop().type) {
+		case NES_EVENT::PPU_NMI:
+			m_pollNmi();
+			break;
+		default:
+			// The rest only stop the CPU so the PPU (or the APU, see
+			// m_updateApu) catches up and rewind records the frame
+			break;
+		}
+	}
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_pollNmi() {
+	// Interrupt CPU if needed
+	if (m_ppu->getNmi()) {
+		m_cpu->nmi();
+		m_ppu->clearNmi();
+	}
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::powerOff() {
 	// Some cleanup here
 	m_isOn = false;
 
@@ -184,26 +479,251 @@ void NesCore::powerOff() {
 
 
 
+// Components are restored memory first, then the buses (which republish
+// direct pages for the restored banks), the PPU, the APU and finally the CPU
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::saveState(std::vector<uint8_t>& state) {
+	state.clear();
+	StateWriter writer(state);
+
+	writer.write(stateMagic);
+	writer.write(stateVersion);
+
+	writer.write((uint64_t)m_totalCyclesPassed);
+	writer.write(m_cpuPhase);
+
+	m_ram->serialize(writer);
+	m_nameTable0->serialize(writer);
+	m_nameTable1->serialize(writer);
+	m_palletteRam->serialize(writer);
+	m_controllers->serialize(writer);
+
+	writer.write((uint8_t)(m_cartridge != nullptr));
+	if (m_cartridge != nullptr)
+		m_cartridge->serialize(writer);
+
+	m_cpuBus->serialize(writer);
+	m_ppuBus->serialize(writer);
+	m_ppu->serialize(writer);
+	m_apu->serialize(writer);
+	m_cpu->serialize(writer);
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+bool NesSystem<cpuType, busType, ppuType>::loadState(const std::vector<uint8_t>& state) {
+	saveState(m_loadRollback);
+
+	try {
+		m_readState(state);
+	}
+	catch (const std::exception& e) {
+		fmt::print("Failed to load state: {}!\n", e.what());
+
+		// Components read before the failure are already overwritten
+		m_readState(m_loadRollback);
+		m_runApu();
+		return false;
+	}
+
+	m_runApu();
+
+	return true;
+}
+
+
+// Throws on states that are truncated, of another version or out of range
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_readState(const std::vector<uint8_t>& state) {
+	StateReader reader(state.data(), state.size());
+
+	reader.expect(stateMagic, "Not a save state");
+	reader.expect(stateVersion, "Save state version doesn't match");
+
+	uint64_t totalCyclesPassed = 0;
+	reader.read(totalCyclesPassed);
+	reader.read(m_cpuPhase);
+	reader.check(m_cpuPhase < 3, "Save state CPU phase is out of range");
+	m_totalCyclesPassed = (size_t)totalCyclesPassed;
+	m_scheduler.clear();
+
+	m_ram->deserialize(reader);
+	m_nameTable0->deserialize(reader);
+	m_nameTable1->deserialize(reader);
+	m_palletteRam->deserialize(reader);
+	m_controllers->deserialize(reader);
+
+	reader.expect((uint8_t)(m_cartridge != nullptr), "Save state cartridge doesn't match");
+	if (m_cartridge != nullptr)
+		m_cartridge->deserialize(reader);
+
+	m_cpuBus->deserialize(reader);
+	m_ppuBus->deserialize(reader);
+	m_ppu->deserialize(reader);
+	m_apu->deserialize(reader);
+	m_cpu->deserialize(reader);
+
+	// The PPU and the APU are run up to the CPU from where they are,
+	// clocks far apart would take that long. Neither is ever more than
+	// a frame and an instruction behind.
+	size_t cpuCycles = m_cpu->getCyclesPassed();
+	reader.check(m_totalCyclesPassed / 3 <= cpuCycles + 0xFFFF && cpuCycles <= m_totalCyclesPassed / 3 + 0xFFFF,
+		"Save state PPU and CPU clocks are too far apart");
+	reader.check(m_apu->getCycle() <= cpuCycles && cpuCycles - m_apu->getCycle() <= 0xFFFF,
+		"Save state APU and CPU clocks are too far apart");
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::setAudioRate(size_t sampleRate) {
+	m_apu->setSampleRate(sampleRate);
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+size_t NesSystem<cpuType, busType, ppuType>::readAudio(int16_t* buffer, size_t maxSamples) {
+	return m_apu->readSamples(buffer, maxSamples);
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::setAudioSink(std::shared_ptr<IAudioSink> sink) {
+	m_audioSink = sink;
+
+	size_t sampleRate = (sink != nullptr) ? sink->sampleRate() : 0;
+	m_apu->setSampleRate(sampleRate);
+
+	// Room for all the APU holds (a quarter of a second), so a frame is one read
+	m_audioBuffer.assign(sampleRate / 4 + 1, 0);
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_pushAudio() {
+	size_t count = m_apu->readSamples(m_audioBuffer.data(), m_audioBuffer.size());
+	m_audioSink->samplesReady(m_audioBuffer.data(), count);
+
+	m_apu->setRateRatio(m_audioSink->rateRatio());
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::setButtons(size_t port, uint8_t buttons) {
+	if (m_movieMode != MOVIE_MODE::PLAYBACK)
+		m_controllers->setButtons(port, buttons);
+}
+
+
+// Starts from a reset, the movie keeps the state right after it
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::recordMovie() {
+	reset();
+
+	std::vector<uint8_t> state;
+	saveState(state);
+
+	m_movie = NesMovie(m_cartridge != nullptr ? m_cartridge->getRomHash() : 0, state);
+	m_movieFrameIndex = 0;
+	m_movieMode = MOVIE_MODE::RECORD;
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+bool NesSystem<cpuType, busType, ppuType>::playMovie(const NesMovie& movie) {
+	uint64_t romHash = (m_cartridge != nullptr) ? m_cartridge->getRomHash() : 0;
+
+	if (movie.romHash() != romHash) {
+		fmt::print("Movie was recorded on a different ROM!\n");
+		return false;
+	}
+
+	m_movieMode = MOVIE_MODE::OFF;
+
+	if (!loadState(movie.startState()))
+		return false;
+
+	m_movie = movie;
+	m_movieFrameIndex = 0;
+	m_movieMode = MOVIE_MODE::PLAYBACK;
+	return true;
+}
+
+
+// Called at the start of every frame while a movie is on
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_movieFrame() {
+	if (m_movieMode == MOVIE_MODE::RECORD) {
+		m_movie.addFrame(m_controllers->getButtons(0), m_controllers->getButtons(1));
+		return;
+	}
+
+	if (m_movieFrameIndex >= m_movie.frames()) {
+		m_movieMode = MOVIE_MODE::OFF;
+		return;
+	}
+
+	m_controllers->setButtons(0, m_movie.buttons(m_movieFrameIndex, 0));
+	m_controllers->setButtons(1, m_movie.buttons(m_movieFrameIndex, 1));
+	m_movieFrameIndex++;
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::enableRewind(size_t capacityMB, size_t keyframeInterval) {
+	m_rewind = std::make_unique<NesRewind>(capacityMB, keyframeInterval);
+	m_rewindFrame = m_ppu->getFrameCount();
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::disableRewind() {
+	m_rewind = nullptr;
+}
+
+
+template <typename cpuType, typename busType, typename ppuType>
+bool NesSystem<cpuType, busType, ppuType>::rewind() {
+	if (m_rewind == nullptr || !m_rewind->restore(m_rewindState))
+		return false;
+
+	return loadState(m_rewindState);
+}
+
+
+// Runs on the emulation thread, compression is left to the rewind's worker
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::m_recordFrame() {
+	m_rewindFrame = m_ppu->getFrameCount();
+
+	saveState(m_rewindState);
+	m_rewind->record(m_rewindState);
+}
+
+
+
 
 //	+---------------------------+
 //	|	Testing/Debug Methods	|
 //	+---------------------------+
 
-void NesCore::runCPU_nCycles(size_t nCycles) {
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::runCPU_nCycles(size_t nCycles) {
 	m_cpu->reset();
 	do {
 		m_cpu->tick();
 	} while (m_cpu->getCyclesPassed() <= nCycles);
 }
 
-void NesCore::runCPU_nCycles(size_t nCycles, uint16_t pc) {
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::runCPU_nCycles(size_t nCycles, uint16_t pc) {
 	m_cpu->reset(pc);
 	do {
 		m_cpu->tick();
 	} while (m_cpu->getCyclesPassed() <= nCycles);
 }
 
-void NesCore::runCPU_nInstructions(size_t nInstructions) {
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::runCPU_nInstructions(size_t nInstructions) {
 	m_cpu->reset();
 	do {
 		m_cpu->tick();
@@ -212,7 +732,8 @@ void NesCore::runCPU_nInstructions(size_t nInstructions) {
 	} while (nInstructions > 0);
 }
 
-void NesCore::runCPU_nInstructions(size_t nInstructions, uint16_t pc) {
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::runCPU_nInstructions(size_t nInstructions, uint16_t pc) {
 	m_cpu->reset(pc);
 	do {
 		m_cpu->tick();
@@ -222,7 +743,8 @@ void NesCore::runCPU_nInstructions(size_t nInstructions, uint16_t pc) {
 }
 
 
-void NesCore::nesTest(const char* romFilePath, const char* memDumpFilePath,
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::nesTest(const char* romFilePath, const char* memDumpFilePath,
 	bool noPpu) {
 
 	if (!loadCartridge(romFilePath))
@@ -231,8 +753,12 @@ void NesCore::nesTest(const char* romFilePath, const char* memDumpFilePath,
 	m_isOn = true;
 
 	m_totalCyclesPassed = 0;
+	m_cpuPhase = 0;
+	m_scheduler.clear();
 	m_cpu->reset(0xC000);
 	m_ppu->reset();
+	m_apu->reset(m_cpu->getCyclesPassed());
+	m_runApu();
 
 
 	while (m_cpu->getCyclesPassed() <= 26555)
@@ -240,3 +766,320 @@ void NesCore::nesTest(const char* romFilePath, const char* memDumpFilePath,
 
 	powerOff();
 }
+
+
+// Runs nestest's automated mode on the CPU alone nRounds times and prints
+// the instruction throughput, the PPU is left out so only dispatch and
+// bus costs are measured
+template <typename cpuType, typename busType, typename ppuType>
+void NesSystem<cpuType, busType, ppuType>::cpuBenchmark(const char* romFilePath, size_t nRounds) {
+	if (!loadCartridge(romFilePath))
+		return;
+
+	size_t nInstructions = 0;
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t round = 0; round < nRounds; round++) {
+		m_cpu->reset(0xC000);
+		size_t startCycle = m_cpu->getCyclesPassed();
+
+		while (m_cpu->getCyclesPassed() - startCycle < 26554) {
+			m_cpu->runCycles(1);
+			nInstructions++;
+		}
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	fmt::print("CPU benchmark: {} instructions in {:.3f}s ({:.2f} Minstr/s)\n",
+		nInstructions, elapsed.count(), nInstructions / elapsed.count() / 1e6);
+}
+
+// Runs the same frames with the dot and the scanline renderer
+// from one save state and compares checksums of every frame, the
+// save states after them and the dot sprite 0's hit shows up on $2002
+template <typename cpuType, typename busType, typename ppuType>
+bool NesSystem<cpuType, busType, ppuType>::rendererTest(const char* romFilePath, size_t nFrames) {
+	if (!loadCartridge(romFilePath))
+		return false;
+
+	reset();
+
+	std::vector<uint8_t> start;
+	saveState(start);
+
+	std::vector<uint64_t> checksums[2];
+	std::vector<std::vector<uint8_t>> states[2];
+	std::vector<size_t> hitDots[2];
+	const RENDER_MODE modes[2] = { RENDER_MODE::DOT, RENDER_MODE::SCANLINE };
+
+	for (size_t mode = 0; mode < 2; mode++) {
+		loadState(start);
+		m_ppu->setRenderMode(modes[mode]);
+
+		for (size_t frame = 0; frame < nFrames; frame++) {
+			// Dot by dot to see $2002 between the CPU's reads
+			size_t frameCount = m_ppu->getFrameCount();
+			size_t hitDot = 0;
+
+			while (m_ppu->getFrameCount() == frameCount) {
+				tick();
+
+				if (hitDot == 0 && (m_ppu->read(0x0002, true) & 0x40))
+					hitDot = m_totalCyclesPassed;
+			}
+
+			hitDots[mode].push_back(hitDot);
+
+			// FNV-1a over the pixels
+			const uint8_t* pixels = (const uint8_t*)m_ppu->getFrameBuffer();
+			uint64_t checksum = 0xCBF29CE484222325;
+			for (size_t byte = 0; byte < IFrameSink::frameWidth * IFrameSink::frameHeight * sizeof(NesColor); byte++)
+				checksum = (checksum ^ pixels[byte]) * 0x100000001B3;
+
+			checksums[mode].push_back(checksum);
+
+			states[mode].emplace_back();
+			saveState(states[mode].back());
+		}
+	}
+
+	m_ppu->setRenderMode(RENDER_MODE::DOT);
+
+	for (size_t frame = 0; frame < nFrames; frame++) {
+		if (checksums[0][frame] != checksums[1][frame]) {
+			fmt::print("Renderer test failed: frame {} differs ({:016X} != {:016X})\n",
+				frame, checksums[0][frame], checksums[1][frame]);
+			return false;
+		}
+
+		if (hitDots[0][frame] != hitDots[1][frame]) {
+			fmt::print("Renderer test failed: sprite 0 hit of frame {} shows at dot {} instead of {}\n",
+				frame, hitDots[1][frame], hitDots[0][frame]);
+			return false;
+		}
+
+		if (states[0][frame] != states[1][frame]) {
+			fmt::print("Renderer test failed: state after frame {} differs\n", frame);
+			return false;
+		}
+	}
+
+	fmt::print("Renderer test passed: {} frames match\n", nFrames);
+	return true;
+}
+
+
+// Runs the same frames from power up in lockstep and with catch-up
+// sync and compares the save states after every frame
+template <typename cpuType, typename busType, typename ppuType>
+bool NesSystem<cpuType, busType, ppuType>::syncTest(const char* romFilePath, size_t nFrames) {
+	if (!loadCartridge(romFilePath))
+		return false;
+
+	reset();
+
+	std::vector<uint8_t> start;
+	saveState(start);
+
+	std::vector<std::vector<uint8_t>> states[2];
+	const PPU_SYNC modes[2] = { PPU_SYNC::LOCKSTEP, PPU_SYNC::CATCH_UP };
+	PPU_SYNC sync = m_ppuSync;
+
+	for (size_t mode = 0; mode < 2; mode++) {
+		loadState(start);
+		m_ppuSync = modes[mode];
+
+		for (size_t frame = 0; frame < nFrames; frame++) {
+			runFrame();
+
+			states[mode].emplace_back();
+			saveState(states[mode].back());
+		}
+	}
+
+	m_ppuSync = sync;
+
+	for (size_t frame = 0; frame < nFrames; frame++) {
+		if (states[0][frame] != states[1][frame]) {
+			fmt::print("Sync test failed: frame {} differs\n", frame);
+			return false;
+		}
+	}
+
+	fmt::print("Sync test passed: {} frames match\n", nFrames);
+	return true;
+}
+
+
+// Plays frames into a NesAudioRing paced like a 60 Hz display would (the
+// NES runs at 60.0988) while a thread stands in for a 48 kHz sound card
+// pulling blocks off it, and checks rate control alone (the producer
+// never waits on the ring) kept it from running dry or overflowing once
+// it got going. Runs in real time.
+template <typename cpuType, typename busType, typename ppuType>
+bool NesSystem<cpuType, busType, ppuType>::audioTest(const char* romFilePath, size_t nFrames) {
+	if (!loadCartridge(romFilePath))
+		return false;
+
+	reset();
+
+	const size_t deviceRate = 48000;
+	const size_t blockSize = 512;
+	const size_t warmupFrames = 60;
+
+	auto ring = std::make_shared<NesAudioRing>(deviceRate);
+	setAudioSink(ring);
+
+	std::atomic<bool> stop{ false };
+	std::thread device([&]() {
+		std::vector<int16_t> block(blockSize);
+		auto period = std::chrono::duration<double>((double)blockSize / deviceRate);
+		auto next = std::chrono::steady_clock::now();
+
+		while (!stop.load()) {
+			ring->read(block.data(), blockSize);
+
+			next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+			std::this_thread::sleep_until(next);
+		}
+	});
+
+	auto framePeriod = std::chrono::duration<double>(1.0 / 60.0);
+	auto start = std::chrono::steady_clock::now();
+
+	size_t underruns = 0;
+	size_t minFill = SIZE_MAX;
+	size_t maxFill = 0;
+
+	for (size_t frame = 0; frame < nFrames; frame++) {
+		runFrame();
+
+		if (frame == warmupFrames)
+			underruns = ring->underruns();
+
+		if (frame >= warmupFrames) {
+			minFill = std::min(minFill, ring->fill());
+			maxFill = std::max(maxFill, ring->fill());
+		}
+
+		std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			framePeriod * (double)(frame + 1)));
+	}
+
+	stop.store(true);
+	device.join();
+
+	underruns = ring->underruns() - underruns;
+	setAudioSink(nullptr);
+
+	fmt::print("Audio fill {}-{} of {} (target {}), {} underruns, {} samples dropped\n",
+		minFill, maxFill, ring->capacity(), ring->target(), underruns, ring->dropped());
+
+	if (underruns > 0 || ring->dropped() > 0) {
+		fmt::print("Audio test failed\n");
+		return false;
+	}
+
+	fmt::print("Audio test passed: {} frames without underruns\n", nFrames);
+	return true;
+}
+
+
+// Records a movie of random buttons, takes it through its file format and
+// plays it back, mashing other buttons that playback has to ignore, and
+// compares the save states after every frame
+template <typename cpuType, typename busType, typename ppuType>
+bool NesSystem<cpuType, busType, ppuType>::movieTest(const char* romFilePath, size_t nFrames) {
+	if (!loadCartridge(romFilePath))
+		return false;
+
+	std::vector<std::vector<uint8_t>> states[2];
+	uint32_t seed = 1;
+
+	auto random = [&seed]() {
+		seed = seed * 1103515245 + 12345;
+		return (uint8_t)(seed >> 16);
+	};
+
+	recordMovie();
+
+	for (size_t frame = 0; frame < nFrames; frame++) {
+		setButtons(0, random());
+		setButtons(1, random());
+		runFrame();
+
+		states[0].emplace_back();
+		saveState(states[0].back());
+	}
+
+	stopMovie();
+
+	std::vector<uint8_t> data;
+	m_movie.serialize(data);
+
+	NesMovie movie;
+	if (!movie.deserialize(data) || !playMovie(movie))
+		return false;
+
+	for (size_t frame = 0; frame < nFrames; frame++) {
+		setButtons(0, random());
+		setButtons(1, random());
+		runFrame();
+
+		states[1].emplace_back();
+		saveState(states[1].back());
+	}
+
+	// One frame past the end switches playback off
+	runFrame();
+	if (m_movieMode != MOVIE_MODE::OFF) {
+		fmt::print("Movie test failed: playback didn't stop\n");
+		return false;
+	}
+
+	for (size_t frame = 0; frame < nFrames; frame++) {
+		if (states[0][frame] != states[1][frame]) {
+			fmt::print("Movie test failed: frame {} differs\n", frame);
+			return false;
+		}
+	}
+
+	// Movie files come from anywhere, a broken start state has to be
+	// refused and leave the system untouched
+	const std::vector<uint8_t>& startState = m_movie.startState();
+	std::vector<std::vector<uint8_t>> brokenStates = {
+		std::vector<uint8_t>(startState.begin(), startState.begin() + startState.size() / 2),
+		std::vector<uint8_t>(startState.begin(), startState.end() - 1),
+		startState
+	};
+	brokenStates.back()[0] ^= 0xFF;
+
+	std::vector<uint8_t> before, after;
+	saveState(before);
+
+	for (const std::vector<uint8_t>& brokenState : brokenStates) {
+		if (playMovie(NesMovie(m_movie.romHash(), brokenState))) {
+			fmt::print("Movie test failed: a broken start state was played\n");
+			return false;
+		}
+
+		saveState(after);
+		if (after != before || m_movieMode != MOVIE_MODE::OFF) {
+			fmt::print("Movie test failed: a broken start state changed the system\n");
+			return false;
+		}
+	}
+
+	fmt::print("Movie test passed: {} frames match ({} byte movie)\n", nFrames, data.size());
+	return true;
+}
+
+
+//	+-----------------------+
+//	|	  Instantiations		|
+//	+-----------------------+
+
+template class NesSystem<INesCpu, IBus<uint16_t, uint8_t>, INesPpu>;
+template class NesSystem<CPU_6502<NesPageTableBus>, NesPageTableBus, PPU_2C02>;
+template class NesSystem<CPU_6502_Cached<NesPageTableBus>, NesPageTableBus, PPU_2C02>;
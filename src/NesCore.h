@@ -1,41 +1,118 @@
 #pragma once
 
+#include <vector>
+
 #include "NesCartridge.h"
 #include "INesCpu.h"
 #include "INesPpu.h"
 #include "IBus.h"
 #include "IRam.h"
 #include "NesArrayRam.h"
+#include "NesPageTableBus.h"
+#include "CPU_6502.h"
+#include "CPU_6502_Cached.h"
+#include "PPU_2C02.h"
+#include "NesRewind.h"
+#include "NesSyncSlave.h"
+#include "NesScheduler.h"
+#include "NesOamDma.h"
+#include "NesControllers.h"
+#include "NesSplitSlave.h"
+#include "NesMovie.h"
+#include "NesApu.h"
+#include "IAudioSink.h"
+
+
+enum class PPU_SYNC {
+	LOCKSTEP,	// PPU catches up after every instruction
+	CATCH_UP	// PPU catches up when the CPU needs it to
+};
+
+
+enum class MOVIE_MODE {
+	OFF,
+	RECORD,		// Every frame's buttons are added to the movie
+	PLAYBACK	// Every frame's buttons come from the movie
+};
 
 
-class NesCore final {
+// The component types are template parameters so that a system built
+// from concrete (final) components calls them without virtual dispatch.
+// NesCore.cpp instantiates the configurations declared below.
+template <typename cpuType, typename busType, typename ppuType>
+class NesSystem final {
 public:
-	NesCore(
-		std::shared_ptr<INesCpu> cpu,
-		std::shared_ptr<INesPpu> ppu,
+	NesSystem(
+		std::shared_ptr<cpuType> cpu,
+		std::shared_ptr<ppuType> ppu,
 		std::shared_ptr<IRam<uint16_t, uint8_t>> ram,
-		std::shared_ptr<IBus<uint16_t, uint8_t>> cpuBus,
-		std::shared_ptr<IBus<uint16_t, uint8_t>> ppuBus
+		std::shared_ptr<busType> cpuBus,
+		std::shared_ptr<busType> ppuBus
 	);
 
-	~NesCore();
+	~NesSystem();
 
 
 	void nesTest(const char* romFilePath, const char* memDumpFilePath,
 				 bool noPpu = true);
+	void cpuBenchmark(const char* romFilePath, size_t nRounds = 100);
+	bool rendererTest(const char* romFilePath, size_t nFrames = 600);
+	bool syncTest(const char* romFilePath, size_t nFrames = 600);
+	bool audioTest(const char* romFilePath, size_t nFrames = 600);
+	bool movieTest(const char* romFilePath, size_t nFrames = 600);
 
 	void powerOn();
 	void powerOff();
 	bool loadCartridge(const char* filePath);
+	bool loadCartridge(std::shared_ptr<const NesRomImage> image);
 	void reset();
 	void tick();
+	void runCycles(size_t nCycles);
+	void runFrame();
+
+	inline void setPpuSync(PPU_SYNC sync) { m_ppuSync = sync; }
+
+	// Audio is off (0) until a sample rate is set, samples are mono
+	// 16 bit and have to be read out regularly, the oldest are dropped
+	// once there's more than a quarter of a second
+	void setAudioRate(size_t sampleRate);
+	size_t readAudio(int16_t* buffer, size_t maxSamples);
+
+	// Or have every frame's samples handed to a sink, at its rate
+	void setAudioSink(std::shared_ptr<IAudioSink> sink);
+
+	// Buttons held on a controller port (0 or 1), bit 0 is A, then B, Select,
+	// Start, Up, Down, Left and Right, the order they're read in. Ignored
+	// while a movie plays back.
+	void setButtons(size_t port, uint8_t buttons);
+
+	// Movies hold the buttons of every runFrame() from where recording
+	// started (a reset) and replay bit-exact on the same ROM. Playback
+	// switches itself off after the last frame. Loading states or rewinding
+	// in between isn't tracked, the movie just carries on from there.
+	void recordMovie();
+	bool playMovie(const NesMovie& movie);
+	void stopMovie() { m_movieMode = MOVIE_MODE::OFF; }
+	MOVIE_MODE getMovieMode() const { return m_movieMode; }
+	const NesMovie& getMovie() const { return m_movie; }
+
+	// Snapshots of the whole machine, saving reuses the buffer's memory.
+	// A state that fails to load leaves the system as it was.
+	void saveState(std::vector<uint8_t>& state);
+	bool loadState(const std::vector<uint8_t>& state);
+
+	// Keeps a state per frame in a NesRewind, rewind() goes back to the
+	// start of the last recorded frame (or the current one if mid-frame)
+	void enableRewind(size_t capacityMB = 10, size_t keyframeInterval = 60);
+	void disableRewind();
+	bool rewind();
 
 private:
-	std::shared_ptr<INesCpu> m_cpu;
-	std::shared_ptr<INesPpu> m_ppu;
+	std::shared_ptr<cpuType> m_cpu;
+	std::shared_ptr<ppuType> m_ppu;
 
-	std::shared_ptr<IBus<uint16_t, uint8_t>> m_cpuBus;
-	std::shared_ptr<IBus<uint16_t, uint8_t>> m_ppuBus;
+	std::shared_ptr<busType> m_cpuBus;
+	std::shared_ptr<busType> m_ppuBus;
 
 	std::shared_ptr<IRam<uint16_t, uint8_t>> m_ram;
 
@@ -47,7 +124,10 @@ private:
 	std::shared_ptr<IRam<uint16_t, uint8_t>> m_nameTable1;
 	std::shared_ptr<IRam<uint16_t, uint8_t>> m_palletteRam;
 
-	std::shared_ptr<IRam<uint16_t, uint8_t>> m_controller1;
+	std::shared_ptr<NesControllers> m_controllers;
+	std::shared_ptr<NesApu> m_apu;
+	std::shared_ptr<IAudioSink> m_audioSink;
+	std::vector<int16_t> m_audioBuffer;
 
 	std::ofstream m_cpuLogFile;
 
@@ -57,11 +137,85 @@ private:
 	void runCPU_nCycles(size_t nCycles, uint16_t pc);
 	void runCPU_nInstructions(size_t nInstructions, uint16_t pc);
 
+	void m_readState(const std::vector<uint8_t>& state);
+	void m_recordFrame();
+	void m_movieFrame();
+
+	void m_catchUpPpu();
+	void m_syncPpu(uint16_t address, bool write);
+	void m_oamDma(uint8_t page);
+
+	void m_syncApu(uint16_t address, bool write);
+	void m_runApu();
+	void m_updateApu();
+	void m_pushAudio();
+
+	void m_schedulePpuEvents();
+	void m_scheduleApuEvent();
+	void m_dispatchEvents();
+	void m_pollNmi();
+
+	// PPU dots are the finest step the system takes
+	inline uint64_t m_masterClock() const {
+		return (uint64_t)m_totalCyclesPassed * NesScheduler::ppuDot;
+	}
+
 private:
 	bool m_realTime = true;
 	long double m_deltaTime = 0.0L;
 
 	bool m_isOn = false;
 	size_t m_totalCyclesPassed = 0;
+	uint8_t m_cpuPhase = 0;
+
+	PPU_SYNC m_ppuSync = PPU_SYNC::CATCH_UP;
+	bool m_catchingUp = false;
+	size_t m_ppuSyncCycle = 0;
+	NesScheduler m_scheduler;
+
+	// CPU cycle the APU next needs the CPU at, and whether
+	// the CPU has touched it since it last had a look
+	size_t m_apuEventCycle = SIZE_MAX;
+	bool m_apuTouched = false;
+
+	// With nothing due the APU still runs about once a frame, so it's
+	// never far behind the CPU (states count on it, see m_readState)
+	static constexpr size_t apuRunInterval = 29781;
+
+	MOVIE_MODE m_movieMode = MOVIE_MODE::OFF;
+	NesMovie m_movie;
+	size_t m_movieFrameIndex = 0;
+
+	// The state before the last load, restored if that load fails
+	std::vector<uint8_t> m_loadRollback;
+
+	std::unique_ptr<NesRewind> m_rewind;
+	std::vector<uint8_t> m_rewindState;
+	size_t m_rewindFrame = 0;
 
 };
+
+
+// Runtime polymorphic system, any component can be swapped for debugging
+typedef NesSystem<INesCpu, IBus<uint16_t, uint8_t>, INesPpu> NesCore;
+
+// System with every component type fixed at compile time
+typedef NesSystem<CPU_6502<NesPageTableBus>, NesPageTableBus, PPU_2C02> NesFastCore;
+
+// NesFastCore with the basic block caching CPU, to A/B the two
+typedef NesSystem<CPU_6502_Cached<NesPageTableBus>, NesPageTableBus, PPU_2C02> NesCachedCore;
+
+// NesFastCore for runs nobody watches (VecNesEnv, the farm). Catch-up
+// sync and the scanline renderer are the fastest. Catch-up matches
+// lockstep, the scanline renderer matches the dot renderer's pixels,
+// $2002 and states unless the PPU is changed mid line (syncTest,
+// rendererTest).
+inline std::unique_ptr<NesFastCore> makeHeadlessCore(std::shared_ptr<PPU_2C02> ppu, std::shared_ptr<NesArrayRam> ram) {
+	ppu->setRenderMode(RENDER_MODE::SCANLINE);
+
+	auto nes = std::make_unique<NesFastCore>(std::make_shared<CPU_6502<NesPageTableBus>>(), ppu, ram,
+		std::make_shared<NesPageTableBus>(false), std::make_shared<NesPageTableBus>(false));
+	nes->setPpuSync(PPU_SYNC::CATCH_UP);
+
+	return nes;
+}
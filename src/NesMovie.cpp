@@ -0,0 +1,96 @@
+#include <fstream>
+#include <iterator>
+
+#include "fmt/printf.h"
+
+#include "NesMovie.h"
+#include "NesState.h"
+
+
+static const uint32_t movieMagic	= 0x564D4E50;	// "PNMV"
+static const uint16_t movieVersion	= 1;
+
+
+void NesMovie::addFrame(uint8_t port0, uint8_t port1) {
+	m_buttons.push_back(port0);
+	m_buttons.push_back(port1);
+}
+
+
+void NesMovie::serialize(std::vector<uint8_t>& data) const {
+	data.clear();
+	StateWriter writer(data);
+
+	writer.write(movieMagic);
+	writer.write(movieVersion);
+	writer.write(m_romHash);
+
+	writer.write((uint32_t)m_startState.size());
+	writer.write(m_startState.data(), m_startState.size());
+
+	writer.write((uint32_t)frames());
+	writer.write(m_buttons.data(), m_buttons.size());
+}
+
+
+bool NesMovie::deserialize(const std::vector<uint8_t>& data) {
+	StateReader reader(data.data(), data.size());
+
+	try {
+		reader.expect(movieMagic, "Not a movie");
+		reader.expect(movieVersion, "Movie version doesn't match");
+
+		uint64_t romHash = 0;
+		reader.read(romHash);
+
+		uint32_t stateSize = 0;
+		reader.read(stateSize);
+		std::vector<uint8_t> startState(stateSize > reader.remaining() ? 0 : stateSize);
+		reader.read(startState.data(), stateSize);
+
+		uint32_t nFrames = 0;
+		reader.read(nFrames);
+		std::vector<uint8_t> buttons((size_t)nFrames * 2 > reader.remaining() ? 0 : (size_t)nFrames * 2);
+		reader.read(buttons.data(), (size_t)nFrames * 2);
+
+		m_romHash = romHash;
+		m_startState = std::move(startState);
+		m_buttons = std::move(buttons);
+	}
+	catch (const std::exception& e) {
+		fmt::print("Failed to load movie: {}!\n", e.what());
+		return false;
+	}
+
+	return true;
+}
+
+
+bool NesMovie::save(const char* filePath) const {
+	std::ofstream file(filePath, std::ofstream::binary);
+
+	if (!file.is_open()) {
+		fmt::print("Couldn't open movie file!\n");
+		return false;
+	}
+
+	std::vector<uint8_t> data;
+	serialize(data);
+	file.write((const char*)data.data(), data.size());
+
+	return file.good();
+}
+
+
+bool NesMovie::load(const char* filePath) {
+	std::ifstream file(filePath, std::ifstream::binary);
+
+	if (!file.is_open()) {
+		fmt::print("Couldn't open movie file!\n");
+		return false;
+	}
+
+	std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	return deserialize(data);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+// Input recorded from power up, replayed to get the exact same run. Holds
+// the hash of the ROM it was made on, the save state the system started
+// from and a byte of buttons per frame for each controller port.
+//
+// Files are "PNMV", a version, the ROM hash, the start state's size and
+// the state, the frame count and then the frames, two bytes each.
+class NesMovie final {
+public:
+	NesMovie() = default;
+	NesMovie(uint64_t romHash, const std::vector<uint8_t>& startState)
+		: m_romHash(romHash), m_startState(startState) {}
+
+	uint64_t romHash() const { return m_romHash; }
+	const std::vector<uint8_t>& startState() const { return m_startState; }
+
+	size_t frames() const { return m_buttons.size() / 2; }
+	uint8_t buttons(size_t frame, size_t port) const { return m_buttons[frame * 2 + (port & 0x01)]; }
+	void addFrame(uint8_t port0, uint8_t port1);
+
+	void serialize(std::vector<uint8_t>& data) const;
+	bool deserialize(const std::vector<uint8_t>& data);
+
+	bool save(const char* filePath) const;
+	bool load(const char* filePath);
+
+private:
+	uint64_t m_romHash = 0;
+	std::vector<uint8_t> m_startState;
+	std::vector<uint8_t> m_buttons;
+};
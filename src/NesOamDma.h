@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+
+#include "IBusSlave.h"
+
+
+// OAM DMA register ($4014), writing N copies $NN00-$NNFF to OAM. The
+// owner does the copy since it takes the CPU's bus, the PPU and the CPU.
+class NesOamDma final : public IBusSlave<uint16_t, uint8_t> {
+public:
+	typedef std::function<void(uint8_t page)> TransferCallback;
+
+	NesOamDma(TransferCallback transfer) : m_transfer(transfer) {}
+
+	inline const uint16_t size() override {
+		return 1;
+	}
+
+	// Write only
+	uint8_t read(uint16_t address, bool readOnly = false) override {
+		return 0x00;
+	}
+
+	void write(uint16_t address, uint8_t data) override {
+		m_transfer(data);
+	}
+
+private:
+	TransferCallback m_transfer;
+};
@@ -0,0 +1,153 @@
+#include <stdexcept>
+#include <algorithm>
+
+#include "fmt/printf.h"
+
+#include "NesPageTableBus.h"
+
+
+void NesPageTableBus::mapSlave(
+	std::shared_ptr<IBusSlave<uint16_t, uint8_t>> slave,
+	uint16_t startAddress, uint16_t endAddress) {
+
+	m_addSlave(slave, startAddress, endAddress);
+}
+
+
+void NesPageTableBus::mapSlave(
+	std::shared_ptr<IBusSlave<uint16_t, uint8_t>> slave,
+	uint16_t startAddress) {
+
+	// Check if the end address goes above the address space
+	if ((size_t)startAddress + slave->size() - 1 > maxAddress) {
+		throw std::overflow_error("Slave's end address overflows possible address space");
+		return;
+	}
+
+	uint16_t endAddress = startAddress + slave->size() - 1;
+	m_addSlave(slave, startAddress, endAddress);
+}
+
+
+void NesPageTableBus::m_addSlave(
+	std::shared_ptr<IBusSlave<uint16_t, uint8_t>> slaveToAdd,
+	uint16_t startAddress, uint16_t endAddress) {
+
+	if (startAddress > endAddress) {
+		throw std::range_error("Slave's start address is above its end address");
+		return;
+	}
+
+	// Check every address of the new slave for overlap
+	for (size_t address = startAddress; address <= endAddress; address++) {
+		if (slaveAt((uint16_t)address) != nullptr) {
+			throw std::range_error("Slave addresses overlaping");
+			return;
+		}
+	}
+
+	IBusSlave<uint16_t, uint8_t>* slave = slaveToAdd.get();
+
+	// Fill the page table
+	for (size_t pageIndex = startAddress / pageSize;
+		pageIndex <= endAddress / pageSize; pageIndex++) {
+
+		Page& page = m_pages[pageIndex];
+		size_t pageStart = pageIndex * pageSize;
+		size_t pageEnd	 = pageStart + pageSize - 1;
+
+		// Slave covers the whole page
+		if (startAddress <= pageStart && endAddress >= pageEnd
+			&& page.split == nullptr) {
+			page.slave = slave;
+
+			DirectPage<uint16_t, uint8_t>& direct = m_directPages[pageIndex];
+			if (!slave->directMemory((uint16_t)pageStart,
+				direct.data, direct.mask, direct.writable))
+				direct = DirectPage<uint16_t, uint8_t>();
+
+			continue;
+		}
+
+		// Slave shares the page, resolve it per address
+		if (page.split == nullptr) {
+			page.split = std::make_unique<SplitPage>();
+			page.split->fill(nullptr);
+		}
+
+		size_t first = std::max(pageStart, (size_t)startAddress);
+		size_t last	 = std::min(pageEnd, (size_t)endAddress);
+
+		for (size_t address = first; address <= last; address++)
+			(*page.split)[address % pageSize] = slave;
+	}
+
+	m_mappingVersion++;
+
+	// Add new slave
+	if (m_logMappings)
+		fmt::printf("Added slave: $%04X-$%04X\n",
+			(int)startAddress, endAddress);
+
+	m_slaves.push_back(slaveToAdd);
+}
+
+
+void NesPageTableBus::m_refreshDirectPages(
+	IBusSlave<uint16_t, uint8_t>* slave) {
+
+	m_mappingVersion++;
+
+	for (size_t pageIndex = 0; pageIndex < pageCount; pageIndex++) {
+		if (m_pages[pageIndex].slave != slave)
+			continue;
+
+		DirectPage<uint16_t, uint8_t>& direct = m_directPages[pageIndex];
+		if (!slave->directMemory((uint16_t)(pageIndex * pageSize),
+			direct.data, direct.mask, direct.writable))
+			direct = DirectPage<uint16_t, uint8_t>();
+	}
+}
+
+
+void NesPageTableBus::deserialize(StateReader& reader) {
+	for (auto& slave : m_slaves)
+		m_refreshDirectPages(slave.get());
+}
+
+
+void NesPageTableBus::getSlaveWithAddress(uint16_t address) {
+	IBusSlave<uint16_t, uint8_t>* slave = slaveAt(address);
+
+	// Find the owning pointer of the slave that occupies the address
+	for (auto& mapped : m_slaves) {
+		if (mapped.get() == slave) {
+			m_tempSlave = mapped;
+			return;
+		}
+	}
+
+	// If no slave has the address return nullptr
+	m_tempSlave = nullptr;
+}
+
+
+void NesPageTableBus::dump_memory(const char* filePath,
+	uint16_t startAddress, uint16_t endAddress) {
+
+	m_memDumpFile.open(filePath, std::ofstream::out);
+
+	if (!m_memDumpFile.is_open()) {
+		fmt::print("Failed to open memdump.log file!\n");
+		return;
+	}
+
+	for (int i = 0; i <= 0xFFFF; i++) {
+		if (i % 0x10 == 0) {
+			fmt::fprintf(m_memDumpFile, "\n0x%04X: ", i);
+		}
+		fmt::fprintf(m_memDumpFile, "%02X ", read(i, true));
+	}
+	m_memDumpFile.close();
+	fmt::printf("Dumped memory to disk ($%04X-$%04X).\n", startAddress, endAddress);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <fstream>
+
+#include "IBus.h"
+
+
+// Bus that resolves slaves through a 256-entry page table built when slaves
+// are mapped, so every access is a single indexed load instead of a search.
+// Pages shared by several slaves (e.g. $4000-$40FF) fall back to a per-address
+// table for that page only. Pages owned by plain memory are also published as
+// DirectPages so masters can skip the slave entirely.
+class NesPageTableBus final : public IBus<uint16_t, uint8_t> {
+public:
+	// Headless pools of systems turn off the line printed per mapped slave
+	NesPageTableBus(bool logMappings = true) : m_logMappings(logMappings) {}
+
+	void mapSlave(std::shared_ptr<IBusSlave<uint16_t, uint8_t>> slave,
+		uint16_t startAddress, uint16_t endAddress) override;
+
+	void mapSlave(std::shared_ptr<IBusSlave<uint16_t, uint8_t>> slave,
+		uint16_t startAddress) override;
+
+	void getSlaveWithAddress(uint16_t address) override;
+
+	inline bool write(uint16_t address, uint8_t data) override {
+		DirectPage<uint16_t, uint8_t>& direct = m_directPages[address / pageSize];
+		if (direct.writable) {
+			direct.data[address & direct.mask] = data;
+			return true;
+		}
+
+		IBusSlave<uint16_t, uint8_t>* slave = slaveAt(address);
+		if (slave == nullptr)
+			return false;
+
+		// Writes may switch banks, plain data writes (e.g. CHR RAM) don't
+		uint32_t version = slave->mappingVersion();
+		slave->write(address, data);
+
+		if (slave->mappingVersion() != version)
+			m_refreshDirectPages(slave);
+
+		return true;
+	}
+
+	inline uint8_t read(uint16_t address, bool readOnly = false) override {
+		const DirectPage<uint16_t, uint8_t>& direct = m_directPages[address / pageSize];
+		if (direct.data != nullptr)
+			return direct.data[address & direct.mask];
+
+		IBusSlave<uint16_t, uint8_t>* slave = slaveAt(address);
+		if (slave == nullptr)
+			return -1;
+
+		return slave->read(address, readOnly);
+	}
+
+	const DirectPage<uint16_t, uint8_t>* directPages() override {
+		return m_directPages.data();
+	}
+
+	uint32_t mappingVersion() override { return m_mappingVersion; }
+
+	void dump_memory(const char* filePath,
+		uint16_t startAddress = 0, uint16_t endAddress = maxAddress) override;
+
+	// Restored slaves (e.g. a mapper's bank) may publish other memory
+	void deserialize(StateReader& reader) override;
+
+private:
+	static const size_t pageSize  = directPageSize;
+	static const size_t pageCount = (maxAddress + 1) / pageSize;
+
+	typedef std::array<IBusSlave<uint16_t, uint8_t>*, pageSize> SplitPage;
+
+	struct Page {
+		// Slave owning the whole page, nullptr if unmapped or split
+		IBusSlave<uint16_t, uint8_t>* slave = nullptr;
+		// Per address slaves, only allocated for pages shared between slaves
+		std::unique_ptr<SplitPage> split = nullptr;
+	};
+
+	inline IBusSlave<uint16_t, uint8_t>* slaveAt(uint16_t address) const {
+		const Page& page = m_pages[address / pageSize];
+
+		if (page.slave != nullptr)
+			return page.slave;
+		if (page.split != nullptr)
+			return (*page.split)[address % pageSize];
+
+		return nullptr;
+	}
+
+	void m_addSlave(std::shared_ptr<IBusSlave<uint16_t, uint8_t>> slave,
+		uint16_t startAddress, uint16_t endAddress);
+
+	void m_refreshDirectPages(IBusSlave<uint16_t, uint8_t>* slave);
+
+private:
+	std::array<Page, pageCount> m_pages;
+	std::array<DirectPage<uint16_t, uint8_t>, pageCount> m_directPages;
+	uint32_t m_mappingVersion = 0;
+	bool m_logMappings;
+
+	// Keeps mapped slaves alive, the page table only holds raw pointers
+	std::vector<std::shared_ptr<IBusSlave<uint16_t, uint8_t>>> m_slaves;
+	std::shared_ptr<IBusSlave<uint16_t, uint8_t>> m_tempSlave = nullptr;
+
+	std::ofstream m_memDumpFile;
+};
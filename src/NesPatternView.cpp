@@ -0,0 +1,56 @@
+#include "NesPatternView.h"
+
+
+NesPatternView::NesPatternView(PPU_2C02* ppu)
+	: m_ppu(ppu), m_image(width * height, NesColor{ 0, 0, 0, 255 }) {
+}
+
+
+bool NesPatternView::update(uint8_t palette) {
+	std::shared_ptr<ITileSource> source = m_ppu->getTileSource();
+
+	// No cartridge, no tiles
+	if (source == nullptr)
+		return false;
+
+	palette &= 0x07;
+
+	uint32_t tileVersion = source->tileVersion();
+	uint32_t colorsVersion = m_ppu->getColorsVersion();
+
+	if (m_drawn && m_source.lock() == source && tileVersion == m_tileVersion
+		&& colorsVersion == m_colorsVersion && palette == m_palette)
+		return false;
+
+	m_draw(source.get(), &m_ppu->getColors()[palette << 2]);
+
+	m_source = source;
+	m_tileVersion = tileVersion;
+	m_colorsVersion = colorsVersion;
+	m_palette = palette;
+	m_drawn = true;
+
+	return true;
+}
+
+
+// Tiles are 16x16 per table, left to right and top to bottom
+void NesPatternView::m_draw(ITileSource* source, const NesColor* colors) {
+	for (int table = 0; table < 2; table++) {
+		for (int tileY = 0; tileY < 16; tileY++) {
+			for (int tileX = 0; tileX < 16; tileX++) {
+				uint16_t offset = table * 0x1000 + tileY * 256 + tileX * 16;
+				NesColor* pixel = &m_image[table * 128 + tileX * 8 + tileY * 8 * width];
+
+				for (int row = 0; row < 8; row++) {
+					uint64_t pixels = source->tileRow(offset + row);
+
+					for (int col = 0; col < 8; col++)
+						pixel[col] = colors[(pixels >> (col * 8)) & 0x03];
+
+					pixel += width;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "IFrameSink.h"
+#include "ITileSource.h"
+#include "PPU_2C02.h"
+
+
+// Debug view of both pattern tables side by side in one of the eight
+// palettes. Built from the PPU's tile source and resolved colors, and
+// only rebuilt when the tiles, the colors or the palette changed since.
+class NesPatternView final {
+public:
+	static const size_t width  = 256;
+	static const size_t height = 128;
+
+	NesPatternView(PPU_2C02* ppu);
+
+	// Rebuilds the image if it's out of date, true if it was
+	bool update(uint8_t palette);
+	const NesColor* getImage() const { return m_image.data(); }
+
+private:
+	void m_draw(ITileSource* source, const NesColor* colors);
+
+private:
+	PPU_2C02* m_ppu;
+	std::vector<NesColor> m_image;
+
+	// What the image was last built from
+	std::weak_ptr<ITileSource> m_source;
+	uint32_t m_tileVersion	 = 0;
+	uint32_t m_colorsVersion = 0;
+	uint8_t	 m_palette		 = 0x00;
+	bool	 m_drawn		 = false;
+};
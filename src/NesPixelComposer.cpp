@@ -0,0 +1,217 @@
+#include "NesPixelComposer.h"
+#include "Config.h"
+
+#ifdef PPU_SIMD
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+
+// MSVC compiles intrinsics for any target, the caller checks the host
+#define TARGET_SSE41
+#define TARGET_AVX2
+#else
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+
+void NesPixelComposer::compose(const uint8_t* pixels, size_t count,
+	const NesColor* colors, NesColor* out) {
+
+	compose(kernel(), pixels, count, colors, out);
+}
+
+
+NesPixelComposer::KERNEL NesPixelComposer::kernel() {
+	static const KERNEL detected = m_detect();
+	return detected;
+}
+
+
+void NesPixelComposer::compose(KERNEL kernel, const uint8_t* pixels, size_t count,
+	const NesColor* colors, NesColor* out) {
+
+	switch (kernel) {
+#ifdef PPU_SIMD
+	case KERNEL::AVX2:
+		m_composeAvx2(pixels, count, colors, out);
+		break;
+	case KERNEL::SSE41:
+		m_composeSse41(pixels, count, colors, out);
+		break;
+#endif
+	default:
+		m_composeScalar(pixels, count, colors, out);
+		break;
+	}
+}
+
+
+NesPixelComposer::KERNEL NesPixelComposer::m_detect() {
+#ifdef PPU_SIMD
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int leaves = info[0];
+
+	__cpuid(info, 1);
+	bool sse41 = (info[2] & (1 << 19)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+
+	// AVX registers are only usable if the OS saves them
+	bool avx2 = false;
+	if (leaves >= 7 && osxsave && avx && (_xgetbv(0) & 0x06) == 0x06) {
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	bool sse41 = __builtin_cpu_supports("sse4.1");
+	bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+	if (avx2)
+		return KERNEL::AVX2;
+	if (sse41)
+		return KERNEL::SSE41;
+#endif
+
+	return KERNEL::SCALAR;
+}
+
+
+//	+-----------------------+
+//	|		 Kernels		|
+//	+-----------------------+
+
+void NesPixelComposer::m_composeScalar(const uint8_t* pixels, size_t count,
+	const NesColor* colors, NesColor* out) {
+
+	for (size_t pixel = 0; pixel < count; pixel++)
+		out[pixel] = colors[pixels[pixel] & 0x1F];
+}
+
+
+#ifdef PPU_SIMD
+
+// The table as one plane per channel, each split in halves of 16 entries
+// for the shuffles. Shuffling with an index only looks at its low 4 bits,
+// bit 4 picks the half.
+struct ColorPlanes {
+	alignas(16) uint8_t low[4][16];
+	alignas(16) uint8_t high[4][16];
+
+	ColorPlanes(const NesColor* colors) {
+		for (int entry = 0; entry < 16; entry++) {
+			low[0][entry] = colors[entry].r;
+			low[1][entry] = colors[entry].g;
+			low[2][entry] = colors[entry].b;
+			low[3][entry] = colors[entry].a;
+
+			high[0][entry] = colors[entry + 16].r;
+			high[1][entry] = colors[entry + 16].g;
+			high[2][entry] = colors[entry + 16].b;
+			high[3][entry] = colors[entry + 16].a;
+		}
+	}
+};
+
+
+TARGET_SSE41
+void NesPixelComposer::m_composeSse41(const uint8_t* pixels, size_t count,
+	const NesColor* colors, NesColor* out) {
+
+	ColorPlanes planes(colors);
+
+	__m128i low[4], high[4];
+	for (int channel = 0; channel < 4; channel++) {
+		low[channel] = _mm_load_si128((const __m128i*)planes.low[channel]);
+		high[channel] = _mm_load_si128((const __m128i*)planes.high[channel]);
+	}
+
+	const __m128i indexMask = _mm_set1_epi8(0x1F);
+
+	size_t pixel = 0;
+	for (; pixel + 16 <= count; pixel += 16) {
+		__m128i index = _mm_and_si128(_mm_loadu_si128((const __m128i*)(pixels + pixel)), indexMask);
+
+		// Bit 4 moved up to bit 7, which is what blendv looks at
+		__m128i upper = _mm_slli_epi16(index, 3);
+
+		__m128i channels[4];
+		for (int channel = 0; channel < 4; channel++)
+			channels[channel] = _mm_blendv_epi8(
+				_mm_shuffle_epi8(low[channel], index),
+				_mm_shuffle_epi8(high[channel], index),
+				upper);
+
+		// Interleave the planes back to RGBA
+		__m128i rgLow = _mm_unpacklo_epi8(channels[0], channels[1]);
+		__m128i rgHigh = _mm_unpackhi_epi8(channels[0], channels[1]);
+		__m128i baLow = _mm_unpacklo_epi8(channels[2], channels[3]);
+		__m128i baHigh = _mm_unpackhi_epi8(channels[2], channels[3]);
+
+		__m128i* destination = (__m128i*)(out + pixel);
+		_mm_storeu_si128(destination + 0, _mm_unpacklo_epi16(rgLow, baLow));
+		_mm_storeu_si128(destination + 1, _mm_unpackhi_epi16(rgLow, baLow));
+		_mm_storeu_si128(destination + 2, _mm_unpacklo_epi16(rgHigh, baHigh));
+		_mm_storeu_si128(destination + 3, _mm_unpackhi_epi16(rgHigh, baHigh));
+	}
+
+	m_composeScalar(pixels + pixel, count - pixel, colors, out + pixel);
+}
+
+
+TARGET_AVX2
+void NesPixelComposer::m_composeAvx2(const uint8_t* pixels, size_t count,
+	const NesColor* colors, NesColor* out) {
+
+	ColorPlanes planes(colors);
+
+	// Shuffles stay within 128 bit lanes, so both lanes get the table
+	__m256i low[4], high[4];
+	for (int channel = 0; channel < 4; channel++) {
+		low[channel] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)planes.low[channel]));
+		high[channel] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)planes.high[channel]));
+	}
+
+	const __m256i indexMask = _mm256_set1_epi8(0x1F);
+
+	size_t pixel = 0;
+	for (; pixel + 32 <= count; pixel += 32) {
+		__m256i index = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(pixels + pixel)), indexMask);
+		__m256i upper = _mm256_slli_epi16(index, 3);
+
+		__m256i channels[4];
+		for (int channel = 0; channel < 4; channel++)
+			channels[channel] = _mm256_blendv_epi8(
+				_mm256_shuffle_epi8(low[channel], index),
+				_mm256_shuffle_epi8(high[channel], index),
+				upper);
+
+		// Unpacking is per lane too, lane 0 holds pixels 0-15 and lane 1
+		// pixels 16-31, so each result has 4 pixels of both halves
+		__m256i rgLow = _mm256_unpacklo_epi8(channels[0], channels[1]);
+		__m256i rgHigh = _mm256_unpackhi_epi8(channels[0], channels[1]);
+		__m256i baLow = _mm256_unpacklo_epi8(channels[2], channels[3]);
+		__m256i baHigh = _mm256_unpackhi_epi8(channels[2], channels[3]);
+
+		__m256i pixels0 = _mm256_unpacklo_epi16(rgLow, baLow);		// 0-3, 16-19
+		__m256i pixels4 = _mm256_unpackhi_epi16(rgLow, baLow);		// 4-7, 20-23
+		__m256i pixels8 = _mm256_unpacklo_epi16(rgHigh, baHigh);	// 8-11, 24-27
+		__m256i pixels12 = _mm256_unpackhi_epi16(rgHigh, baHigh);	// 12-15, 28-31
+
+		__m256i* destination = (__m256i*)(out + pixel);
+		_mm256_storeu_si256(destination + 0, _mm256_permute2x128_si256(pixels0, pixels4, 0x20));
+		_mm256_storeu_si256(destination + 1, _mm256_permute2x128_si256(pixels8, pixels12, 0x20));
+		_mm256_storeu_si256(destination + 2, _mm256_permute2x128_si256(pixels0, pixels4, 0x31));
+		_mm256_storeu_si256(destination + 3, _mm256_permute2x128_si256(pixels8, pixels12, 0x31));
+	}
+
+	m_composeScalar(pixels + pixel, count - pixel, colors, out + pixel);
+}
+
+#endif
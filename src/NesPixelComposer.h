@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "IFrameSink.h"
+
+
+// Last step of rendering a line, pixels are 5 bit palette RAM offsets
+// (attribute bits above the 2 bit pattern value, sprites at 16-31) which
+// are turned into colors through a table of 32 already resolved colors.
+// Greyscale and emphasis are applied when that table is built, so the
+// kernels are only table lookups: SSE4.1 does 16 and AVX2 32 pixels at
+// a time with byte shuffles, one per table half and color channel.
+class NesPixelComposer final {
+public:
+	enum class KERNEL {
+		SCALAR,
+		SSE41,
+		AVX2
+	};
+
+	static void compose(const uint8_t* pixels, size_t count,
+		const NesColor* colors, NesColor* out);
+
+	// The best kernel the host supports, picked on first use
+	static KERNEL kernel();
+
+	// Runs a specific kernel, the host has to support it
+	static void compose(KERNEL kernel, const uint8_t* pixels, size_t count,
+		const NesColor* colors, NesColor* out);
+
+private:
+	static KERNEL m_detect();
+
+	static void m_composeScalar(const uint8_t* pixels, size_t count,
+		const NesColor* colors, NesColor* out);
+	static void m_composeSse41(const uint8_t* pixels, size_t count,
+		const NesColor* colors, NesColor* out);
+	static void m_composeAvx2(const uint8_t* pixels, size_t count,
+		const NesColor* colors, NesColor* out);
+};
@@ -0,0 +1,270 @@
+#include "NesRewind.h"
+
+
+NesRewind::NesRewind(size_t capacityMB, size_t keyframeInterval)
+	: m_capacity(capacityMB * 1024 * 1024),
+	m_keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1) {
+
+	m_worker = std::thread(&NesRewind::m_work, this);
+}
+
+
+NesRewind::~NesRewind() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_wake.notify_all();
+	m_worker.join();
+}
+
+
+// Called every frame, so it only copies the state into a spare buffer
+void NesRewind::record(const std::vector<uint8_t>& state) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_spare.empty()) {
+			m_pending.emplace_back(state);
+		}
+		else {
+			m_pending.push_back(std::move(m_spare.back()));
+			m_spare.pop_back();
+			m_pending.back().assign(state.begin(), state.end());
+		}
+	}
+
+	m_wake.notify_one();
+}
+
+
+bool NesRewind::restore(std::vector<uint8_t>& state) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_waitIdle(lock);
+
+	if (m_entries.empty())
+		return false;
+
+	state = m_previous;
+
+	Entry& newest = m_entries.back();
+	bool keyframe = newest.keyframe;
+
+	// XOR is its own inverse, undoing the delta gives the state before it
+	if (!keyframe) {
+		m_decode(newest.data, m_previous.data());
+		m_sinceKeyframe--;
+	}
+
+	m_memoryUsed -= newest.data.size() + sizeof(Entry);
+	m_entries.pop_back();
+
+	// Otherwise rebuild the state before from the keyframe before
+	if (keyframe) {
+		m_previous.clear();
+		m_sinceKeyframe = 0;
+
+		if (!m_entries.empty()) {
+			size_t first = m_entries.size() - 1;
+			while (!m_entries[first].keyframe)
+				first--;
+
+			m_previous.assign(m_entries[first].stateSize, 0x00);
+			for (size_t entry = first; entry < m_entries.size(); entry++)
+				m_decode(m_entries[entry].data, m_previous.data());
+
+			m_sinceKeyframe = m_entries.size() - 1 - first;
+		}
+	}
+
+	return true;
+}
+
+
+void NesRewind::clear() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_waitIdle(lock);
+
+	m_entries.clear();
+	m_previous.clear();
+	m_memoryUsed = 0;
+	m_sinceKeyframe = 0;
+}
+
+
+size_t NesRewind::frames() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_waitIdle(lock);
+
+	return m_entries.size();
+}
+
+
+size_t NesRewind::memoryUsed() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_waitIdle(lock);
+
+	return m_memoryUsed;
+}
+
+
+//	+-----------------------+
+//	|		  Worker		|
+//	+-----------------------+
+
+void NesRewind::m_work() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true) {
+		m_wake.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+		if (m_stop)
+			break;
+
+		std::vector<uint8_t> state = std::move(m_pending.front());
+		m_pending.pop_front();
+		m_busy = true;
+
+		// Only the worker touches the previous state while busy
+		lock.unlock();
+		Entry entry = m_compress(state);
+		lock.lock();
+
+		m_memoryUsed += entry.data.size() + sizeof(Entry);
+		m_entries.push_back(std::move(entry));
+		m_trim();
+
+		m_spare.push_back(std::move(state));
+		m_busy = false;
+
+		m_idle.notify_all();
+	}
+}
+
+
+NesRewind::Entry NesRewind::m_compress(const std::vector<uint8_t>& state) {
+	Entry entry;
+	entry.stateSize = state.size();
+	entry.keyframe = m_previous.size() != state.size() ||
+		m_sinceKeyframe + 1 >= m_keyframeInterval;
+
+	m_encoded.clear();
+	m_encode(state.data(), entry.keyframe ? nullptr : m_previous.data(),
+		state.size(), m_encoded);
+
+	// Copied out so the entry holds no slack
+	entry.data.assign(m_encoded.begin(), m_encoded.end());
+
+	m_sinceKeyframe = entry.keyframe ? 0 : m_sinceKeyframe + 1;
+	m_previous.assign(state.begin(), state.end());
+
+	return entry;
+}
+
+
+// Drops whole keyframe groups from the front, the newest one always stays
+void NesRewind::m_trim() {
+	while (m_memoryUsed > m_capacity) {
+		size_t next = 1;
+		while (next < m_entries.size() && !m_entries[next].keyframe)
+			next++;
+
+		if (next == m_entries.size())
+			return;
+
+		for (size_t entry = 0; entry < next; entry++) {
+			m_memoryUsed -= m_entries.front().data.size() + sizeof(Entry);
+			m_entries.pop_front();
+		}
+	}
+}
+
+
+void NesRewind::m_waitIdle(std::unique_lock<std::mutex>& lock) {
+	m_idle.wait(lock, [this] { return m_pending.empty() && !m_busy; });
+}
+
+
+//	+-----------------------+
+//	|	   Delta Encoding		|
+//	+-----------------------+
+
+void NesRewind::m_encode(const uint8_t* state, const uint8_t* previous,
+	size_t size, std::vector<uint8_t>& encoded) {
+
+	auto delta = [state, previous](size_t i) -> uint8_t {
+		return previous ? (state[i] ^ previous[i]) : state[i];
+	};
+
+	// Literals swallow gaps shorter than this, a run costs a few bytes
+	static const size_t minimumRun = 4;
+
+	size_t i = 0;
+	while (i < size) {
+		size_t unchanged = 0;
+		while (i < size && delta(i) == 0) {
+			unchanged++;
+			i++;
+		}
+
+		size_t start = i;
+		while (i < size) {
+			if (delta(i) != 0) {
+				i++;
+				continue;
+			}
+
+			size_t gap = 0;
+			while (i + gap < size && gap < minimumRun && delta(i + gap) == 0)
+				gap++;
+
+			if (gap == minimumRun || i + gap == size)
+				break;
+
+			i += gap;
+		}
+
+		m_writeVarint(encoded, unchanged);
+		m_writeVarint(encoded, i - start);
+
+		for (size_t literal = start; literal < i; literal++)
+			encoded.push_back(delta(literal));
+	}
+}
+
+// XORs the encoded bytes into state
+void NesRewind::m_decode(const std::vector<uint8_t>& encoded, uint8_t* state) {
+	size_t position = 0;
+	size_t offset = 0;
+
+	while (position < encoded.size()) {
+		offset += m_readVarint(encoded, position);
+		size_t literals = m_readVarint(encoded, position);
+
+		for (size_t literal = 0; literal < literals; literal++)
+			state[offset++] ^= encoded[position++];
+	}
+}
+
+void NesRewind::m_writeVarint(std::vector<uint8_t>& encoded, size_t value) {
+	while (value >= 0x80) {
+		encoded.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+
+	encoded.push_back((uint8_t)value);
+}
+
+size_t NesRewind::m_readVarint(const std::vector<uint8_t>& encoded, size_t& position) {
+	size_t value = 0;
+
+	for (size_t shift = 0; position < encoded.size(); shift += 7) {
+		uint8_t byte = encoded[position++];
+		value |= (size_t)(byte & 0x7F) << shift;
+
+		if ((byte & 0x80) == 0)
+			break;
+	}
+
+	return value;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+// History of save states to step back through, one per frame. Every
+// keyframeInterval-th state is kept whole and the others as the XOR against
+// the state before them, both run length encoded (mostly RAM and nametables
+// change, so deltas are a few hundred bytes). The emulation thread only
+// copies states in, a worker thread compresses them. Whenever the history
+// outgrows its capacity the oldest keyframe and its deltas are dropped.
+class NesRewind final {
+public:
+	NesRewind(size_t capacityMB = 10, size_t keyframeInterval = 60);
+	~NesRewind();
+
+	NesRewind(const NesRewind&) = delete;
+	NesRewind& operator=(const NesRewind&) = delete;
+
+	void record(const std::vector<uint8_t>& state);
+
+	// Takes the newest state out of the history, false once it's empty
+	bool restore(std::vector<uint8_t>& state);
+	void clear();
+
+	size_t frames();
+	size_t memoryUsed();
+
+private:
+	struct Entry {
+		bool keyframe = false;
+		size_t stateSize = 0;
+		std::vector<uint8_t> data;
+	};
+
+	void m_work();
+	Entry m_compress(const std::vector<uint8_t>& state);
+	void m_trim();
+	void m_waitIdle(std::unique_lock<std::mutex>& lock);
+
+	// XOR of state and previous (zeros if null) as runs of
+	// unchanged bytes followed by literal XORed bytes
+	static void m_encode(const uint8_t* state, const uint8_t* previous,
+		size_t size, std::vector<uint8_t>& encoded);
+	static void m_decode(const std::vector<uint8_t>& encoded, uint8_t* state);
+
+	static void m_writeVarint(std::vector<uint8_t>& encoded, size_t value);
+	static size_t m_readVarint(const std::vector<uint8_t>& encoded, size_t& position);
+
+private:
+	size_t m_capacity;
+	size_t m_keyframeInterval;
+
+	std::deque<Entry> m_entries;
+	size_t m_memoryUsed = 0;
+	size_t m_sinceKeyframe = 0;
+
+	// Newest state uncompressed, deltas are taken against it
+	std::vector<uint8_t> m_previous;
+	std::vector<uint8_t> m_encoded;
+
+	// States waiting for the worker and buffers to reuse for them
+	std::deque<std::vector<uint8_t>> m_pending;
+	std::vector<std::vector<uint8_t>> m_spare;
+
+	bool m_busy = false;
+	bool m_stop = false;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_idle;
+	std::thread m_worker;
+};
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
+#include <memory>
+
+#include "NesTileCache.h"
 
 // INES Format Header
 struct romHeader {
@@ -14,3 +18,19 @@ struct romHeader {
 	uint8_t tv_system2;
 	char unused[5];
 };
+
+
+// A ROM file as read from disk. Cartridges only ever read it, so systems
+// running the same game can share one (see NesCartridge::loadImage).
+struct NesRomImage {
+	romHeader header;
+	std::vector<uint8_t> prg;
+	std::vector<uint8_t> chr;	// Empty if the cartridge has CHR RAM
+
+	// CHR ROM decoded once for every cartridge made from the image, null
+	// with CHR RAM (each cartridge decodes its own as it's written)
+	std::unique_ptr<NesTileCache> chrTiles;
+
+	// FNV-1a of the header and the PRG and CHR ROM, tells dumps apart
+	uint64_t hash = 0;
+};
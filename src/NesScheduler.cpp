@@ -0,0 +1,82 @@
+#include "NesScheduler.h"
+
+
+void NesScheduler::schedule(NES_EVENT type, uint64_t time) {
+	cancel(type);
+
+	m_heap[m_size] = { time, type };
+	m_siftUp(m_size++);
+}
+
+
+void NesScheduler::cancel(NES_EVENT type) {
+	for (size_t index = 0; index < m_size; index++) {
+		if (m_heap[index].type == type) {
+			m_remove(index);
+			return;
+		}
+	}
+}
+
+
+void NesScheduler::clear() {
+	m_size = 0;
+}
+
+
+NesEvent NesScheduler::pop() {
+	NesEvent event = m_heap[0];
+	m_remove(0);
+
+	return event;
+}
+
+
+//	+-----------------------+
+//	|		   Heap			|
+//	+-----------------------+
+
+void NesScheduler::m_remove(size_t index) {
+	m_heap[index] = m_heap[--m_size];
+
+	if (index < m_size) {
+		m_siftUp(index);
+		m_siftDown(index);
+	}
+}
+
+void NesScheduler::m_siftUp(size_t index) {
+	while (index > 0) {
+		size_t parent = (index - 1) / 2;
+		if (m_heap[parent].time <= m_heap[index].time)
+			break;
+
+		NesEvent event = m_heap[parent];
+		m_heap[parent] = m_heap[index];
+		m_heap[index] = event;
+
+		index = parent;
+	}
+}
+
+void NesScheduler::m_siftDown(size_t index) {
+	while (true) {
+		size_t smallest = index;
+		size_t left = index * 2 + 1;
+		size_t right = left + 1;
+
+		if (left < m_size && m_heap[left].time < m_heap[smallest].time)
+			smallest = left;
+		if (right < m_size && m_heap[right].time < m_heap[smallest].time)
+			smallest = right;
+
+		if (smallest == index)
+			break;
+
+		NesEvent event = m_heap[smallest];
+		m_heap[smallest] = m_heap[index];
+		m_heap[index] = event;
+
+		index = smallest;
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+
+// Things that happen at a known point in time, the system
+// runs the CPU up to the earliest one and then handles it
+enum class NES_EVENT : uint8_t {
+	RUN_END,			// The CPU reached the cycle it was asked to run to
+	PPU_FRAME,			// PPU completes a frame, only while rewind records them
+	PPU_NMI,			// PPU raises NMI, VBlank with NMI enabled
+	APU,				// APU raises the frame IRQ or the DMC fetches
+
+	COUNT
+};
+
+
+struct NesEvent {
+	uint64_t time;		// Master clock cycles since power up
+	NES_EVENT type;
+};
+
+
+// Min-heap of pending events, at most one per type so that rescheduling
+// replaces the old prediction. Times are in master clock cycles (21.477 MHz
+// on NTSC) which both the CPU (every 12th) and the PPU (every 4th) divide.
+class NesScheduler final {
+public:
+	static const uint64_t cpuCycle = 12;
+	static const uint64_t ppuDot = 4;
+
+	void schedule(NES_EVENT type, uint64_t time);
+	void cancel(NES_EVENT type);
+	void clear();
+
+	inline bool empty() const { return m_size == 0; }
+	inline const NesEvent& next() const { return m_heap[0]; }
+	NesEvent pop();
+
+private:
+	void m_remove(size_t index);
+	void m_siftUp(size_t index);
+	void m_siftDown(size_t index);
+
+private:
+	static const size_t capacity = (size_t)NES_EVENT::COUNT;
+
+	NesEvent m_heap[capacity];
+	size_t m_size = 0;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+
+#include "IBusSlave.h"
+
+
+// Sends reads to one slave and writes to another, for addresses two
+// devices share ($4017 reads controller 2 and writes the APU)
+class NesSplitSlave final : public IBusSlave<uint16_t, uint8_t> {
+public:
+	NesSplitSlave(std::shared_ptr<IBusSlave<uint16_t, uint8_t>> reader,
+		std::shared_ptr<IBusSlave<uint16_t, uint8_t>> writer)
+		: m_reader(reader), m_writer(writer) {}
+
+	inline const uint16_t size() override {
+		return m_reader->size();
+	}
+
+	uint8_t read(uint16_t address, bool readOnly = false) override {
+		return m_reader->read(address, readOnly);
+	}
+
+	void write(uint16_t address, uint8_t data) override {
+		m_writer->write(address, data);
+	}
+
+private:
+	std::shared_ptr<IBusSlave<uint16_t, uint8_t>> m_reader;
+	std::shared_ptr<IBusSlave<uint16_t, uint8_t>> m_writer;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+
+// Save states are the components' fields back to back in host byte order,
+// behind a magic and a version. Bump stateVersion whenever a component
+// changes what it writes, states of other versions are refused on load.
+static const uint32_t stateMagic	= 0x53454E50;	// "PNES"
+static const uint16_t stateVersion	= 6;
+
+
+// Appends to a caller owned buffer so snapshots can reuse its memory
+class StateWriter {
+public:
+	StateWriter(std::vector<uint8_t>& buffer) : m_buffer(buffer) {}
+
+	template <typename T>
+	inline void write(const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "State values must be plain data");
+		write(&value, sizeof(T));
+	}
+
+	inline void write(const void* data, size_t size) {
+		size_t offset = m_buffer.size();
+		m_buffer.resize(offset + size);
+
+		if (size != 0)
+			std::memcpy(m_buffer.data() + offset, data, size);
+	}
+
+private:
+	std::vector<uint8_t>& m_buffer;
+};
+
+
+// Reads back what StateWriter wrote, running past the end or reading
+// a value out of range throws
+class StateReader {
+public:
+	StateReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+	template <typename T>
+	inline void read(T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "State values must be plain data");
+		read(&value, sizeof(T));
+	}
+
+	// Flags are stored as a byte, anything but 0 or 1 isn't a bool
+	inline void read(bool& value) {
+		uint8_t byte;
+		read(&byte, 1);
+
+		check(byte <= 1, "Save state flag is out of range");
+		value = byte != 0;
+	}
+
+	inline void read(void* data, size_t size) {
+		if (size > m_size - m_offset)
+			throw std::out_of_range("Save state is truncated");
+
+		if (size != 0)
+			std::memcpy(data, m_data + m_offset, size);
+		m_offset += size;
+	}
+
+	// Reads a size written next to a block of memory and checks it
+	template <typename T>
+	inline void expect(T value, const char* what) {
+		T stored;
+		read(stored);
+
+		if (stored != value)
+			throw std::runtime_error(what);
+	}
+
+	// Refuses values the emulation would index or loop with out of range
+	inline void check(bool valid, const char* what) {
+		if (!valid)
+			throw std::runtime_error(what);
+	}
+
+	inline size_t remaining() const { return m_size - m_offset; }
+
+private:
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_offset = 0;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <functional>
+
+#include "IBusSlave.h"
+
+
+// Stands in for a slave that runs behind the CPU (the PPU when it's
+// caught up lazily, the APU). Every access first calls sync so the owner can bring
+// the slave up to date, then goes to the slave itself.
+class NesSyncSlave final : public IBusSlave<uint16_t, uint8_t> {
+public:
+	typedef std::function<void(uint16_t address, bool write)> SyncCallback;
+
+	NesSyncSlave(std::shared_ptr<IBusSlave<uint16_t, uint8_t>> slave, SyncCallback sync)
+		: m_slave(slave), m_sync(sync) {}
+
+	inline const uint16_t size() override {
+		return m_slave->size();
+	}
+
+	uint8_t read(uint16_t address, bool readOnly = false) override {
+		m_sync(address, false);
+		return m_slave->read(address, readOnly);
+	}
+
+	void write(uint16_t address, uint8_t data) override {
+		m_sync(address, true);
+		m_slave->write(address, data);
+	}
+
+private:
+	std::shared_ptr<IBusSlave<uint16_t, uint8_t>> m_slave;
+	SyncCallback m_sync;
+};
@@ -0,0 +1,52 @@
+#include <algorithm>
+
+#include "NesTileCache.h"
+
+
+NesTileCache::NesTileCache(const uint8_t* chr, uint32_t size, bool writable)
+	: m_chr(chr), m_rows(size / 2), m_stale(size / 16, 0) {
+
+	if (writable)
+		invalidateAll();
+	else
+		for (uint32_t tile = 0; tile < size / 16; tile++)
+			m_decode(tile);
+}
+
+
+void NesTileCache::invalidateAll() {
+	std::fill(m_stale.begin(), m_stale.end(), 1);
+}
+
+
+uint64_t NesTileCache::decodeRow(uint8_t lsb, uint8_t msb) {
+	uint64_t pixels = 0;
+
+	// Bit 7 is the leftmost pixel
+	for (int col = 0; col < 8; col++) {
+		uint64_t pixel = ((lsb >> (7 - col)) & 0x01) | (((msb >> (7 - col)) & 0x01) << 1);
+		pixels |= pixel << (col * 8);
+	}
+
+	return pixels;
+}
+
+
+uint64_t NesTileCache::flipRow(uint64_t row) {
+	uint64_t flipped = 0;
+
+	for (int col = 0; col < 8; col++)
+		flipped |= ((row >> (col * 8)) & 0xFF) << ((7 - col) * 8);
+
+	return flipped;
+}
+
+
+void NesTileCache::m_decode(uint32_t tile) {
+	const uint8_t* planes = m_chr + tile * 16;
+
+	for (int row = 0; row < 8; row++)
+		m_rows[tile * 8 + row] = decodeRow(planes[row], planes[row + 8]);
+
+	m_stale[tile] = 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+// Decoded copy of CHR memory, every 16 byte tile as 8 rows of 8 pixels
+// packed into a uint64_t. ROM tiles are decoded once up front and only
+// ever read after, so threads can share them. RAM tiles are marked stale
+// when written and decoded again when next used.
+class NesTileCache final {
+public:
+	NesTileCache(const uint8_t* chr, uint32_t size, bool writable);
+
+	// chrAddress is an offset into CHR memory, as mapped by the mapper
+	inline uint64_t row(uint32_t chrAddress) {
+		uint32_t tile = chrAddress >> 4;
+
+		if (m_stale[tile])
+			m_decode(tile);
+
+		return m_rows[tile * 8 + (chrAddress & 0x07)];
+	}
+
+	inline void invalidate(uint32_t chrAddress) { m_stale[chrAddress >> 4] = 1; }
+	void invalidateAll();
+
+	// Bitplane bytes of one row to its pixels
+	static uint64_t decodeRow(uint8_t lsb, uint8_t msb);
+
+	// Mirrors a row horizontally
+	static uint64_t flipRow(uint64_t row);
+
+private:
+	void m_decode(uint32_t tile);
+
+private:
+	const uint8_t* m_chr;
+	std::vector<uint64_t> m_rows;
+	std::vector<uint8_t> m_stale;
+};
@@ -1,88 +1,27 @@
+#include <algorithm>
+#include <cstring>
+
 #include "fmt/printf.h"
 
 #include "PPU_2C02.h"
 
 
 PPU_2C02::PPU_2C02() : m_size(8) {
-	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-		fmt::print("Couldn't initialize SDL video!");
-		return;
-	}
-
-	m_window = SDL_CreateWindow(
-		"POCNESEMU", 
-		SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-		1024, 960, NULL
-	);
-
-	m_renderer = SDL_CreateRenderer(m_window, -1, 0);
-	m_screen = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA32,
-		SDL_TEXTUREACCESS_STREAMING, 256, 240);
-	m_screenBuffer = new SDL_Color[256 * 240];
-	
-	m_patternWindow = SDL_CreateWindow(
-		"POCNESEMU - Pattern Tables",
-		SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-		512, 240, SDL_WINDOW_HIDDEN
-	);
-
-	m_patternRenderer = SDL_CreateRenderer(m_patternWindow, 0, 0);
-	m_patternScreen = SDL_CreateTexture(m_patternRenderer, SDL_PIXELFORMAT_RGBA32,
-		SDL_TEXTUREACCESS_STREAMING, 256, 128);
-	m_patternBuffer = new SDL_Color[256 * 128];
+	m_screenBuffer.resize(IFrameSink::frameWidth * IFrameSink::frameHeight, m_palette[0x0F]);
 
 	// Set "At Power" internal state
 	PPU_CTRL.data = 0x00;
 	PPU_MASK.data = 0x00;
 	PPU_STATUS.data = 0xA0;
 	addressLatch = 0;
-	ppuAddress = 0x0000;
+	vramAddress.data = 0x0000;
+	tramAddress.data = 0x0000;
+	fineX = 0;
 	dataBuffer = 0x00;
 }
 
 
-PPU_2C02::~PPU_2C02() {
-	if (m_renderer != nullptr)
-		SDL_DestroyRenderer(m_renderer);
-	if (m_window != nullptr)
-		SDL_DestroyWindow(m_window);
-	if (m_screen != nullptr)
-		SDL_DestroyTexture(m_screen);
-	if (m_screenBuffer != nullptr)
-		delete[] m_screenBuffer;
-	if (m_patternRenderer != nullptr)
-		SDL_DestroyRenderer(m_patternRenderer);
-	if (m_patternWindow != nullptr)
-		SDL_DestroyWindow(m_patternWindow);
-	if (m_patternScreen != nullptr)
-		SDL_DestroyTexture(m_patternScreen);
-	if (m_patternBuffer != nullptr)
-		delete[] m_patternBuffer;
-
-	SDL_Quit();
-}
-
-
-bool PPU_2C02::isRunning() {
-	return m_isRunning;
-}
-
-bool PPU_2C02::getNmi() {
-	return m_nmi;
-}
-
-void PPU_2C02::clearNmi() {
-	m_nmi = false;
-	PPU_CTRL.enableNmi = 0;
-}
-
-int PPU_2C02::getCycle() {
-	return m_cycle;
-}
-
-int PPU_2C02::getScanline() {
-	return m_scanline;
-}
+PPU_2C02::~PPU_2C02() {}
 
 
 void PPU_2C02::connectBus(std::shared_ptr<IBus<uint16_t, uint8_t>> bus) {
@@ -102,31 +41,20 @@ void PPU_2C02::reset() {
 	m_cycle = 0;
 	m_scanline = 0;
 	m_isRunning = true;
+	m_colorsDirty = true;
 
-	// Initialize screen buffer with a value and render it
-	for (int i = 0; i < 256 * 240; i++) {
-		m_screenBuffer[i] = m_palette[0x0F];
-	}
-	
-	for (int i = 0; i < 256 * 128; i++) {
-		m_patternBuffer[i] = m_palette[0x0F];
-	}
-
-	SDL_UpdateTexture(m_screen, NULL, m_screenBuffer, sizeof(SDL_Color) * 256);
-	SDL_RenderCopy(m_renderer, m_screen, NULL, NULL);
-	SDL_RenderPresent(m_renderer);
-
-
-	SDL_UpdateTexture(m_patternScreen, NULL, m_patternBuffer, sizeof(SDL_Color) * 256);
-	SDL_RenderCopy(m_patternRenderer, m_patternScreen, NULL, NULL);
-	SDL_RenderPresent(m_patternRenderer);
+	// Initialize screen buffer with a value
+	clearFrameBuffer();
 }
 
 
 void PPU_2C02::tick() {
-	// Set VBlank and NMI
-	if (m_scanline == -1 && m_cycle == 1)
+	// Set VBlank and NMI, the pre-render line clears the flags
+	if (m_scanline == 0xFFFF && m_cycle == 1) {
 		PPU_STATUS.verticalBlank = 0;
+		PPU_STATUS.spr0Hit = 0;
+		PPU_STATUS.sprOverflow = 0;
+	}
 
 	if (m_scanline == 241 && m_cycle == 1)
 		PPU_STATUS.verticalBlank = 1;
@@ -140,154 +68,503 @@ void PPU_2C02::tick() {
 	if (m_cycle >= 341) {
  		m_cycle = 0;
  		m_scanline++;
+ 		m_spriteZeroDot = 0;
  		if (m_scanline >= 261) {
  			m_scanline = -1;
  			m_frameComplete = true;
+ 			m_frameCount++;
  		}
 	}
 
 
-	// Render background pixel
-	if (PPU_MASK.bgShow) {
-		if (m_cycle < 256 && m_scanline < 240 && m_scanline != -1) {
-			const int tileX = m_cycle / 8;
-			const int tileY = m_scanline / 8;
-			const int col = m_cycle % 8;
-			const int row = m_scanline % 8;
-			const int index = tileY * 32 + tileX;
-
-			// Run this per tile
-			if (col == 0) {
-				m_tile_lsb = readFrom(PPU_CTRL.bgPattern * 0x1000
-					+ readFrom(0x2000 + index) * 16 + row + 0);
-				m_tile_msb = readFrom(PPU_CTRL.bgPattern * 0x1000
-					+ readFrom(0x2000 + index) * 16 + row + 8);
-
-
-				if ((tileX & 0x03) < 2 && (tileY & 0x03) < 2) {
-					// top left
-					m_shift = 0;
-					m_pos = 0b00000011;
-				}
-				else if ((tileX & 0x03) >= 2 && (tileY & 0x03) < 2) {
-					// top right
-					m_shift = 2;
-					m_pos = 0b00001100;
-				}
-				else if ((tileX & 0x03) < 2 && (tileY & 0x03) >= 2) {
-					// bottom left
-					m_shift = 4;
-					m_pos = 0b00110000;
-				}
-				else if ((tileX & 0x03) >= 2 && (tileY & 0x03) >= 2) {
-					// bottom right
-					m_shift = 6;
-					m_pos = 0b11000000;
-				}
+	const bool rendering = PPU_MASK.bgShow || PPU_MASK.sprShow;
+
+	// Visible lines and the pre-render line (-1, which wraps above 240)
+	if (rendering && (m_scanline < 240 || m_scanline == 0xFFFF)) {
+		const bool visible = m_scanline < 240;
+
+		// The pre-render line draws nothing, both paths run it dot by dot
+		if (m_renderMode == RENDER_MODE::DOT || !visible) {
+			// The background only moves on every 8th dot
+			if ((m_cycle & 0x07) <= 1)
+				m_updateBackground();
+
+			// Dots 1-256 output pixels 0-255
+			if (visible && m_cycle >= 1 && m_cycle <= 256)
+				m_renderPixel();
+		}
+		else {
+			// Sprite 0's hit is found as the line starts and raised on its dot
+			if (m_cycle == 1)
+				m_findSpriteZeroHit();
+
+			if (m_spriteZeroDot != 0 && m_cycle == m_spriteZeroDot)
+				PPU_STATUS.spr0Hit = 1;
+
+			// Render the whole line at once, once its last pixel is due.
+			// Past the line both paths run the same fetches.
+			if (m_cycle == 256)
+				m_renderScanline();
+			else if (m_cycle > 256 && (m_cycle & 0x07) <= 1)
+				m_updateBackground();
+		}
+
+		// Scrolling, see m_incrementX for the coarse X steps. Sprites for
+		// the next line are picked once this one is drawn.
+		if (m_cycle >= 256) {
+			if (m_cycle == 256) {
+				m_incrementY(vramAddress);
 			}
+			else if (m_cycle == 257) {
+				m_copyX();
+				m_evaluateSprites();
+			}
+			else if (!visible && m_cycle >= 280 && m_cycle <= 304) {
+				m_copyY();
+			}
+		}
+	}
 
-			// Set color for the specific pixel
-			m_screenBuffer[m_cycle + m_scanline * 256]
-				= m_palette[
-					readFrom(
-						0x3F00 +
-						(((readFrom(0x23C0 + tileX / 4 + (tileY / 4) * 8) & m_pos) >> m_shift) << 2)
-						+ ((m_tile_lsb & (0x80 >> col)) != 0) | (((m_tile_msb & (0x80 >> col)) != 0) << 1)
-					) & (PPU_MASK.greyScale ? 0x30 : 0xFF)
-				];
+
+	// Run this per frame
+	if (m_frameComplete) {
+		if (m_frameSink != nullptr) {
+			m_frameSink->frameComplete(m_screenBuffer.data());
+
+			if (!m_frameSink->isOpen())
+				m_isRunning = false;
 		}
+
+		m_frameComplete = false;
 	}
 
+	m_cycle++;
+}
 
-	// Render sprites
-	if (PPU_MASK.sprShow)
-		void;
 
+size_t PPU_2C02::dotsUntilNmi() {
+	if (!PPU_CTRL.enableNmi)
+		return SIZE_MAX;
 
-	// Run this per frame
-	if (m_frameComplete) {
-		// Render pattern memory
-		for (int tileY = 0; tileY < 16; tileY++) {
-			for (int tileX = 0; tileX < 16; tileX++) {
-				int offset = tileY * 256 + tileX * 16;
-
-				for (int row = 0; row < 8; row++) {
-					int tile_lsb = readFrom(offset + row + 0);
-					int tile_msb = readFrom(offset + row + 8);
-
-					for (int col = 0; col < 8; col++) {
-						uint8_t pixel = (tile_lsb & 0x01) | ((tile_msb & 0x01) << 1);
-						tile_lsb >>= 1; tile_msb >>= 1;
-
-						m_patternBuffer[tileX * 8 + (7 - col) +
-							(tileY * 8 + row) * 256] = 
-							m_palette[
-								readFrom(0x3F00 + (m_selectedPalette << 2) + pixel)
-							];;
-					}
-				}
-			}
+	// Raised on the next tick if VBlank is already set
+	if (PPU_STATUS.verticalBlank)
+		return 0;
+
+	return m_dotsUntil(241, 1);
+}
+
+
+size_t PPU_2C02::dotsUntilFrameEnd() {
+	return m_dotsUntil(260, 341);
+}
+
+
+// Dots before the tick that starts at the given position. Ticks start at
+// cycles 1-341 of scanlines -1 (pre-render) to 260, so each position is
+// scanline slot * 341 + cycle - 1 in a frame of 262 * 341 dots.
+size_t PPU_2C02::m_dotsUntil(uint16_t scanline, uint16_t cycle) {
+	const size_t frameDots = 262 * 341;
+
+	auto position = [](uint16_t scanline, uint16_t cycle) -> size_t {
+		size_t slot = (scanline == 0xFFFF) ? 0 : scanline + 1;
+		return slot * 341 + cycle - 1;
+	};
+
+	// Reset leaves cycle 0, one dot before cycle 1 like the end of the last line
+	return (position(scanline, cycle) + frameDots - position(m_scanline, m_cycle)) % frameDots;
+}
+
+
+// Runs the background shift registers. They hold the palette indices of
+// the current and the next tile a byte per pixel, and move on a whole tile
+// at a time: the dots in between only pick a pixel further along (see
+// m_renderPixel). Every 8 dots the tile fetched during the last 8 moves
+// in and the one after is fetched, so the first two tiles of a line are
+// fetched at the end of the line before it (dots 321-336). Real hardware
+// fetches piecewise over those 8 dots, here it's all on the last one.
+// On visible lines the scanline path does dots 8-256 in m_renderScanline.
+void PPU_2C02::m_updateBackground() {
+	const bool fetching = (m_cycle >= 8 && m_cycle <= 257) || (m_cycle >= 328 && m_cycle <= 337);
+
+	switch (m_cycle % 8) {
+	case 1:
+		if (fetching) {
+			m_bgShiftLow = m_bgShiftHigh;
+			m_bgShiftHigh = m_nextTile;
+		}
+		break;
+	case 0:
+		if (fetching) {
+			m_nextTile = m_fetchTile(vramAddress);
+			m_incrementX(vramAddress);
 		}
+		break;
+	}
+}
 
-		for (int tileY = 0; tileY < 16; tileY++) {
-			for (int tileX = 0; tileX < 16; tileX++) {
-				int offset = tileY * 256 + tileX * 16;
-
-				for (int row = 0; row < 8; row++) {
-					int tile_lsb = readFrom(0x1000 + offset + row + 0);
-					int tile_msb = readFrom(0x1000 + offset + row + 8);
-
-					for (int col = 0; col < 8; col++) {
-						uint8_t pixel = (tile_lsb & 0x01) | ((tile_msb & 0x01) << 1);
-						tile_lsb >>= 1; tile_msb >>= 1;
-
-						m_patternBuffer[128 + tileX * 8 + (7 - col) +
-							(tileY * 8 + row) * 256] =
-							m_palette[
-								readFrom(0x3F00 + (m_selectedPalette << 2) + pixel)
-							];
-					}
-				}
-			}
+
+// One dot of the visible picture, x is the cycle - 1
+void PPU_2C02::m_renderPixel() {
+	const int x = m_cycle - 1;
+
+	uint8_t pixel = 0x00;
+
+	// Fine X picks the pixel out of the shift registers, past the
+	// current tile's last pixel it's one of the next tile's
+	if (PPU_MASK.bgShow && (x >= 8 || PPU_MASK.bgShowLeft)) {
+		const int offset = (x & 0x07) + fineX;
+
+		if (offset < 8)
+			pixel = (m_bgShiftLow >> (offset * 8)) & 0x0F;
+		else
+			pixel = (m_bgShiftHigh >> ((offset - 8) * 8)) & 0x0F;
+	}
+
+	if (PPU_MASK.sprShow && (x >= 8 || PPU_MASK.sprShowLeft)) {
+		// The first opaque sprite on this dot wins, lower OAM index first
+		for (uint8_t sprite = 0; sprite < m_spriteCount; sprite++) {
+			const Sprite& current = m_sprites[sprite];
+			const int offset = x - current.x;
+
+			if (offset < 0 || offset >= 8)
+				continue;
+
+			uint8_t value = (current.pixels >> (offset * 8)) & 0x03;
+			if (value == 0)
+				continue;
+
+			if (current.zero && (pixel & 0x03) && x != 255)
+				PPU_STATUS.spr0Hit = 1;
+
+			// Behind the background only where it's opaque
+			if (!(current.attribute & 0x20) || !(pixel & 0x03))
+				pixel = 0x10 | ((current.attribute & 0x03) << 2) | value;
+
+			break;
 		}
+	}
 
+	// Set color for the specific pixel
+	if (m_colorsDirty)
+		m_refreshColors();
 
-		// Poll Events
-		SDL_PollEvent(&m_event);
-		if (m_event.type == SDL_WINDOWEVENT
-			&& m_event.window.event == SDL_WINDOWEVENT_CLOSE) {
-			if (SDL_GetWindowID(m_window) == m_event.window.windowID) {
-				m_isRunning = false;
-			} 
-			if (SDL_GetWindowID(m_patternWindow) == m_event.window.windowID) {
-				SDL_HideWindow(m_patternWindow);
-			}
+	m_screenBuffer[x + m_scanline * 256] = m_colors[pixel];
+}
+
+
+// Fills the sprite slots (secondary OAM) for the next line. Y in OAM is
+// one less than the sprite's top line, so comparing against this line
+// gives the sprites of the next one. Overflow is set for a ninth sprite,
+// without the hardware's buggy diagonal scan.
+void PPU_2C02::m_evaluateSprites() {
+	m_spriteCount = 0;
+
+	// Nothing is ever on line 0
+	if (m_scanline >= 240)
+		return;
+
+	const int height = PPU_CTRL.sprSize ? 16 : 8;
+
+	for (int entry = 0; entry < 64; entry++) {
+		const uint8_t* sprite = &m_oam[entry * 4];
+
+		int row = (int)m_scanline - sprite[0];
+		if (row < 0 || row >= height)
+			continue;
+
+		if (m_spriteCount == 8) {
+			PPU_STATUS.sprOverflow = 1;
+			break;
 		}
-		else if (m_event.type == SDL_KEYDOWN) {
-			if (m_event.key.keysym.sym == SDLK_LEFTBRACKET)
-				--m_selectedPalette &= 0x07;
-			if (m_event.key.keysym.sym == SDLK_RIGHTBRACKET)
-				++m_selectedPalette &= 0x07;
-			if (m_event.key.keysym.sym == SDLK_p)
-				SDL_ShowWindow(m_patternWindow);
+
+		const uint8_t tile = sprite[1];
+		const uint8_t attribute = sprite[2];
+
+		// Flipped vertically
+		if (attribute & 0x80)
+			row = height - 1 - row;
+
+		// 8x16 sprites pick their table with bit 0 of the tile,
+		// the bottom half is the tile after the top one
+		uint16_t address;
+		if (height == 16)
+			address = (tile & 0x01) * 0x1000 + (tile & 0xFE) * 16 + (row & 0x08) * 2 + (row & 0x07);
+		else
+			address = PPU_CTRL.sprPattern * 0x1000 + tile * 16 + row;
+
+		Sprite& slot = m_sprites[m_spriteCount++];
+		slot.pixels = m_fetchTileRow(address);
+		slot.x = sprite[3];
+		slot.attribute = attribute;
+		slot.zero = (entry == 0);
+
+		// Flipped horizontally
+		if (attribute & 0x40)
+			slot.pixels = NesTileCache::flipRow(slot.pixels);
+	}
+}
+
+
+// Same pixels as the dot path as long as nothing changes mid line. The
+// first two tiles are in the shift registers since the line before, the
+// rest are fetched in one go, which leaves the address and the shift
+// registers where the dot path has them after dot 256 (before that the
+// address stays where the line started). Fine X can show part of a 33rd
+// tile. The line is built as palette indices first and colored in one go.
+void PPU_2C02::m_renderScanline() {
+	uint64_t fetched[34] = { m_bgShiftLow, m_bgShiftHigh };
+
+	for (int tile = 2; tile < 34; tile++) {
+		fetched[tile] = m_fetchTile(vramAddress);
+		m_incrementX(vramAddress);
+	}
+
+	m_bgShiftLow = fetched[31];
+	m_bgShiftHigh = fetched[32];
+	m_nextTile = fetched[33];
+
+	if (m_colorsDirty)
+		m_refreshColors();
+
+	uint8_t tiles[33 * 8] = {};
+	uint8_t* line = tiles + fineX;
+
+	if (PPU_MASK.bgShow) {
+		uint8_t* pixel = tiles;
+
+		for (int tile = 0; tile < 33; tile++) {
+			for (int col = 0; col < 8; col++)
+				*pixel++ = (uint8_t)(fetched[tile] >> (col * 8));
 		}
 
+		if (!PPU_MASK.bgShowLeft)
+			std::fill(line, line + 8, 0x00);
+	}
 
-		// Render Frame
-		SDL_UpdateTexture(m_screen, NULL, m_screenBuffer, sizeof(SDL_Color) * 256);
-		SDL_RenderCopy(m_renderer, m_screen, NULL, NULL);
-		SDL_RenderPresent(m_renderer);
+	if (PPU_MASK.sprShow && m_spriteCount > 0)
+		m_mixSprites(line);
 
-		SDL_UpdateTexture(m_patternScreen, NULL, m_patternBuffer,
-			sizeof(SDL_Color) * 256);
-		SDL_RenderCopy(m_patternRenderer, m_patternScreen, NULL, NULL);
-		SDL_RenderCopy(m_patternRenderer, m_patternScreen, NULL, NULL);
-		SDL_RenderPresent(m_patternRenderer);
+	NesPixelComposer::compose(line, 256, m_colors, &m_screenBuffer[m_scanline * 256]);
+}
 
-		m_frameComplete = false;
+
+// Pixels of the tile at the address with its palette bits
+uint64_t PPU_2C02::m_fetchTile(LOOPY address) {
+	uint8_t tile = readFrom(0x2000 | (address.data & 0x0FFF));
+	uint8_t attribute = readFrom(0x23C0 | (address.data & 0x0C00) |
+		((address.data >> 4) & 0x38) | ((address.data >> 2) & 0x07));
+
+	// Each attribute byte covers 4x4 tiles, 2 bits per 2x2 quadrant
+	uint8_t shift = ((address.coarseY & 0x02) << 1) | (address.coarseX & 0x02);
+
+	uint64_t pixels = m_fetchTileRow(PPU_CTRL.bgPattern * 0x1000 + tile * 16 + address.fineY);
+	return pixels | (uint64_t)(((attribute >> shift) & 0x03) << 2) * 0x0101010101010101;
+}
+
+
+// Every 8 dots (8-256, 328 and 336) once the tile is fetched,
+// wrapping into the horizontally next nametable
+void PPU_2C02::m_incrementX(LOOPY& address) {
+	if (address.coarseX == 31) {
+		address.coarseX = 0;
+		address.nameTableX = ~address.nameTableX;
+	}
+	else {
+		address.coarseX++;
 	}
+}
 
-	m_cycle++;
+
+// Dot 256, down one pixel row. Nametables are 30 tiles high, rows
+// 30 and 31 (attributes) wrap without switching nametables.
+void PPU_2C02::m_incrementY(LOOPY& address) {
+	if (address.fineY < 7) {
+		address.fineY++;
+		return;
+	}
+
+	address.fineY = 0;
+
+	if (address.coarseY == 29) {
+		address.coarseY = 0;
+		address.nameTableY = ~address.nameTableY;
+	}
+	else if (address.coarseY == 31) {
+		address.coarseY = 0;
+	}
+	else {
+		address.coarseY++;
+	}
+}
+
+
+// Dot 257, back to the line's first tile
+void PPU_2C02::m_copyX() {
+	vramAddress.coarseX = tramAddress.coarseX;
+	vramAddress.nameTableX = tramAddress.nameTableX;
+}
+
+
+// Dots 280-304 of the pre-render line, back to the top
+void PPU_2C02::m_copyY() {
+	vramAddress.fineY = tramAddress.fineY;
+	vramAddress.coarseY = tramAddress.coarseY;
+	vramAddress.nameTableY = tramAddress.nameTableY;
+}
+
+
+// Draws the line's sprites over its background. Sprites are laid out
+// last to first so lower OAM indices end up on top, every dot holds the
+// palette index of its sprite plus whether it's behind the background
+// (bit 6). Sprite 0's hit is up to m_findSpriteZeroHit.
+void PPU_2C02::m_mixSprites(uint8_t* line) {
+	uint8_t sprites[256] = {};
+
+	for (int sprite = m_spriteCount - 1; sprite >= 0; sprite--) {
+		const Sprite& current = m_sprites[sprite];
+		const uint8_t flags = 0x10 | ((current.attribute & 0x03) << 2) |
+			((current.attribute & 0x20) << 1);
+
+		for (int col = 0; col < 8 && current.x + col < 256; col++) {
+			uint8_t value = (current.pixels >> (col * 8)) & 0x03;
+
+			if (value != 0)
+				sprites[current.x + col] = flags | value;
+		}
+	}
+
+	for (int x = PPU_MASK.sprShowLeft ? 0 : 8; x < 256; x++) {
+		const uint8_t sprite = sprites[x];
+		if (sprite == 0)
+			continue;
+
+		const bool background = (line[x] & 0x03) != 0;
+
+		if (!(sprite & 0x40) || !background)
+			line[x] = sprite & 0x1F;
+	}
+}
+
+
+// Sprite 0's hit for the scanline path, which draws the line too late
+// to raise it. Finds the first dot where sprite 0 is opaque over opaque
+// background from the line's first tiles (see m_renderScanline), the
+// flag goes up on that dot (x + 1) like it does on the dot path.
+void PPU_2C02::m_findSpriteZeroHit() {
+	m_spriteZeroDot = 0;
+
+	// Entry 0 is always evaluated first, so it's in the first slot
+	if (!PPU_MASK.bgShow || !PPU_MASK.sprShow || m_spriteCount == 0 || !m_sprites[0].zero)
+		return;
+
+	const Sprite& sprite = m_sprites[0];
+	const int left = (PPU_MASK.bgShowLeft && PPU_MASK.sprShowLeft) ? 0 : 8;
+
+	for (int col = 0; col < 8; col++) {
+		const int x = sprite.x + col;
+		if (x < left || ((sprite.pixels >> (col * 8)) & 0x03) == 0)
+			continue;
+
+		// Pixel 255 never hits
+		if (x >= 255)
+			return;
+
+		// Tiles 0 and 1 are in the shift registers, the rest are
+		// where the address goes from there
+		const int tile = (x + fineX) / 8;
+		uint64_t pixels = (tile == 0) ? m_bgShiftLow : m_bgShiftHigh;
+
+		if (tile >= 2) {
+			LOOPY address = vramAddress;
+			for (int step = 2; step < tile; step++)
+				m_incrementX(address);
+
+			pixels = m_fetchTile(address);
+		}
+
+		if ((pixels >> (((x + fineX) & 0x07) * 8)) & 0x03) {
+			m_spriteZeroDot = x + 1;
+			return;
+		}
+	}
+}
+
+
+// The hit isn't part of save states, a state loaded or the scanline
+// path picked mid line finds it again for the rest of the line
+void PPU_2C02::m_resumeSpriteZeroHit() {
+	m_spriteZeroDot = 0;
+
+	if (m_renderMode == RENDER_MODE::SCANLINE && m_scanline < 240 && m_cycle > 1 && m_cycle <= 256)
+		m_findSpriteZeroHit();
+}
+
+
+// Palette RAM only changes through $2007 and the mask only through
+// $2001, both mark the table dirty so it's rebuilt before its next use
+void PPU_2C02::m_refreshColors() {
+	for (int entry = 0; entry < 0x20; entry++)
+		m_colors[entry] = m_resolveColor(entry);
+
+	m_colorsDirty = false;
+	m_colorsVersion++;
+}
+
+
+// Color of a palette RAM entry as the current mask shows it
+NesColor PPU_2C02::m_resolveColor(uint8_t entry) {
+	NesColor color = m_palette[readFrom(0x3F00 + entry) & (PPU_MASK.greyScale ? 0x30 : 0x3F)];
+
+	// Emphasizing a channel dims the other two
+	uint8_t emphasis = PPU_MASK.data >> 5;
+	if (emphasis != 0) {
+		if (emphasis & 0x06)
+			color.r = color.r * 3 / 4;
+		if (emphasis & 0x05)
+			color.g = color.g * 3 / 4;
+		if (emphasis & 0x03)
+			color.b = color.b * 3 / 4;
+	}
+
+	return color;
+}
+
+
+// Without a tile source (no cartridge) both bitplanes come over the bus
+uint64_t PPU_2C02::m_fetchTileRow(uint16_t address) {
+	if (m_tileSource != nullptr)
+		return m_tileSource->tileRow(address);
+
+	return NesTileCache::decodeRow(readFrom(address + 0), readFrom(address + 8));
+}
+
+
+void PPU_2C02::setRenderMode(RENDER_MODE mode) {
+	m_renderMode = mode;
+	m_resumeSpriteZeroHit();
+
+	clearFrameBuffer();
+}
+
+
+void PPU_2C02::clearFrameBuffer() {
+	std::fill(m_screenBuffer.begin(), m_screenBuffer.end(), m_palette[0x0F]);
+}
+
+
+const NesColor* PPU_2C02::getColors() {
+	if (m_colorsDirty)
+		m_refreshColors();
+
+	return m_colors;
+}
+
+
+uint32_t PPU_2C02::getColorsVersion() {
+	if (m_colorsDirty)
+		m_refreshColors();
+
+	return m_colorsVersion;
 }
 
 
@@ -315,7 +592,8 @@ uint8_t PPU_2C02::read(uint16_t address, bool readOnly) {
 	case 0x0003:	// OAM Address
 		break;
 	case 0x0004:	// OAM Data
-		break;
+		// Reads don't increment the address
+		return m_oam[m_oamAddress];
 	case 0x0005:	// Scroll
 		break;
 	case 0x0006:	// PPU Address
@@ -325,15 +603,15 @@ uint8_t PPU_2C02::read(uint16_t address, bool readOnly) {
 			return dataBuffer;
 
 		m_tempData = dataBuffer;
-		dataBuffer = readFrom(ppuAddress);
+		dataBuffer = readFrom(vramAddress.data & 0x3FFF);
 
 		// Pallette reads are not delayed
-		if (ppuAddress >= 0x3F00) {
-			ppuAddress++;
+		if ((vramAddress.data & 0x3FFF) >= 0x3F00) {
+			vramAddress.data += (PPU_CTRL.incrementMode ? 32 : 1);
 			return dataBuffer;
 		}
 
-		ppuAddress++;
+		vramAddress.data += (PPU_CTRL.incrementMode ? 32 : 1);
 		return m_tempData;
 	}
 
@@ -346,9 +624,15 @@ void PPU_2C02::write(uint16_t address, uint8_t data) {
 	switch (address % m_size) {
 	case 0x0000:	// Control
 		PPU_CTRL.data = data;
+		tramAddress.nameTableX = PPU_CTRL.nameTableX;
+		tramAddress.nameTableY = PPU_CTRL.nameTableY;
 
 		break;
 	case 0x0001:	// Mask
+		// Greyscale and emphasis are part of the resolved colors
+		if ((PPU_MASK.data ^ data) & 0xE1)
+			m_colorsDirty = true;
+
 		PPU_MASK.data = data;
 
 		break;
@@ -356,30 +640,135 @@ void PPU_2C02::write(uint16_t address, uint8_t data) {
 		break;
 
 	case 0x0003:	// OAM Address
+		m_oamAddress = data;
+
 		break;
 
 	case 0x0004:	// OAM Data
+		m_oam[m_oamAddress++] = data;
+
 		break;
 
 	case 0x0005:	// Scroll
+		// X first, then Y
+		if (addressLatch == 0) {
+			fineX = data & 0x07;
+			tramAddress.coarseX = data >> 3;
+			addressLatch = 1;
+		}
+		else {
+			tramAddress.fineY = data & 0x07;
+			tramAddress.coarseY = data >> 3;
+			addressLatch = 0;
+		}
+
 		break;
 
 	case 0x0006:	// PPU Address
+		// High byte (6 bits) first, the low byte also sets v
 		if (addressLatch == 0) {
-			ppuAddress = (ppuAddress & 0x00FF) | (data << 8);
+			tramAddress.data = (tramAddress.data & 0x00FF) | ((data & 0x3F) << 8);
 			addressLatch = 1;
 		}
 		else {
-			ppuAddress = (ppuAddress & 0xFF00) | data;
+			tramAddress.data = (tramAddress.data & 0xFF00) | data;
+			vramAddress = tramAddress;
 			addressLatch = 0;
 		}
 
 		break;
 	case 0x0007:	// PPU Data
-		writeTo(ppuAddress, data);
-		ppuAddress += (PPU_CTRL.incrementMode ? 32 : 1);
+		if ((vramAddress.data & 0x3FFF) >= 0x3F00)
+			m_colorsDirty = true;
+
+		writeTo(vramAddress.data & 0x3FFF, data);
+		vramAddress.data += (PPU_CTRL.incrementMode ? 32 : 1);
 
 		break;
 
 	}
 }
+
+
+// OAM DMA, fills all of OAM starting at (and wrapping around to) OAMADDR
+void PPU_2C02::writeOam(const uint8_t* data) {
+	std::memcpy(m_oam + m_oamAddress, data, 256 - m_oamAddress);
+	std::memcpy(m_oam, data + 256 - m_oamAddress, m_oamAddress);
+}
+
+
+// Registers, latches and the beam position, the screen
+// buffers are redrawn within a frame so they're left out
+void PPU_2C02::serialize(StateWriter& writer) {
+	writer.write(PPU_CTRL.data);
+	writer.write(PPU_MASK.data);
+	writer.write(PPU_STATUS.data);
+
+	writer.write(vramAddress.data);
+	writer.write(tramAddress.data);
+	writer.write(fineX);
+	writer.write(addressLatch);
+	writer.write(dataBuffer);
+	writer.write(m_tempData);
+
+	writer.write(m_cycle);
+	writer.write(m_scanline);
+	writer.write(m_nmi);
+	writer.write(m_frameComplete);
+
+	writer.write(m_bgShiftLow);
+	writer.write(m_bgShiftHigh);
+	writer.write(m_nextTile);
+
+	writer.write(m_oam);
+	writer.write(m_oamAddress);
+
+	writer.write(m_spriteCount);
+	for (const Sprite& sprite : m_sprites) {
+		writer.write(sprite.pixels);
+		writer.write(sprite.x);
+		writer.write(sprite.attribute);
+		writer.write(sprite.zero);
+	}
+}
+
+
+void PPU_2C02::deserialize(StateReader& reader) {
+	reader.read(PPU_CTRL.data);
+	reader.read(PPU_MASK.data);
+	reader.read(PPU_STATUS.data);
+
+	reader.read(vramAddress.data);
+	reader.read(tramAddress.data);
+	reader.read(fineX);
+	reader.check(fineX < 8, "Save state PPU fine X is out of range");
+	reader.read(addressLatch);
+	reader.read(dataBuffer);
+	reader.read(m_tempData);
+
+	reader.read(m_cycle);
+	reader.read(m_scanline);
+	reader.check(m_cycle <= 341 && (m_scanline <= 260 || m_scanline == 0xFFFF),
+		"Save state PPU dot is out of range");
+	reader.read(m_nmi);
+	reader.read(m_frameComplete);
+
+	reader.read(m_bgShiftLow);
+	reader.read(m_bgShiftHigh);
+	reader.read(m_nextTile);
+
+	reader.read(m_oam);
+	reader.read(m_oamAddress);
+
+	reader.read(m_spriteCount);
+	reader.check(m_spriteCount <= 8, "Save state sprite count is out of range");
+	for (Sprite& sprite : m_sprites) {
+		reader.read(sprite.pixels);
+		reader.read(sprite.x);
+		reader.read(sprite.attribute);
+		reader.read(sprite.zero);
+	}
+
+	m_colorsDirty = true;
+	m_resumeSpriteZeroHit();
+}
@@ -3,10 +3,11 @@
 #include <cstdint>
 #include <memory>
 #include <random>
-
-#include "sdl/SDL.h"
+#include <vector>
 
 #include "INesPpu.h"
+#include "NesTileCache.h"
+#include "NesPixelComposer.h"
 
 
 class PPU_2C02 final : public INesPpu {
@@ -17,12 +18,32 @@ public:
 	void reset() override;
 	void tick()  override;
 
-	bool inline isRunning() override;
-	bool inline getNmi()	override;
-	void inline clearNmi()	override;
+	bool isRunning() override { return m_isRunning; }
+	bool getNmi()	 override { return m_nmi; }
+	void clearNmi()	 override { m_nmi = false; PPU_CTRL.enableNmi = 0; }
+
+	int getCycle()	  override { return m_cycle; }
+	int getScanline() override { return m_scanline; }
+
+	size_t getFrameCount() override { return m_frameCount; }
+
+	void setFrameSink(std::shared_ptr<IFrameSink> sink) override { m_frameSink = sink; }
+	void setTileSource(std::shared_ptr<ITileSource> source) override { m_tileSource = source; }
+	std::shared_ptr<ITileSource> getTileSource() { return m_tileSource; }
+	const NesColor* getFrameBuffer() override { return m_screenBuffer.data(); }
+	// Fills the frame buffer with the power up black, save states leave it out
+	void clearFrameBuffer();
+	void setRenderMode(RENDER_MODE mode) override;
 
-	int inline	getCycle()	  override;
-	int inline	getScanline() override;
+	void writeOam(const uint8_t* data) override;
+
+	size_t dotsUntilNmi() override;
+	size_t dotsUntilFrameEnd() override;
+
+	// Palette RAM as colors (32 of them), greyscale and emphasis applied.
+	// The version changes whenever the colors might have.
+	const NesColor* getColors();
+	uint32_t getColorsVersion();
 
 
 
@@ -35,6 +56,9 @@ public:
 	inline const uint16_t size() override { return m_size; }
 	uint8_t read(uint16_t address, bool readOnly = false) override;
 	void write(uint16_t address, uint8_t data) override;
+
+	void serialize(StateWriter& writer) override;
+	void deserialize(StateReader& reader) override;
 	// --------------
 
 private:
@@ -58,35 +82,63 @@ private:
 	uint8_t  m_tempData	  = 0x00;
 	uint16_t m_cycle	  = 0x00;
 	uint16_t m_scanline   = 0x00;
+	size_t	 m_frameCount = 0;
 						  
-	uint16_t ppuAddress	  = 0x00;
 	uint8_t  addressLatch = 0x00;
 	uint8_t  dataBuffer	  = 0x00;
 
-	uint8_t  m_tile_lsb	  = 0x00;
-	uint8_t  m_tile_msb   = 0x00;
-	uint8_t	 m_pos		  = 0x00;
-	uint8_t	 m_shift	  = 0x00;
+	// Background palette indices of the current and next tile, a byte each
+	uint64_t m_bgShiftLow  = 0x00;
+	uint64_t m_bgShiftHigh = 0x00;
+	uint64_t m_nextTile	   = 0x00;
+
+	size_t m_dotsUntil(uint16_t scanline, uint16_t cycle);
+
+	// Rendering
+	void m_updateBackground();
+	void m_renderPixel();
+	void m_renderScanline();
+	void m_evaluateSprites();
+	void m_mixSprites(uint8_t* line);
+	void m_findSpriteZeroHit();
+	void m_resumeSpriteZeroHit();
+	uint64_t m_fetchTileRow(uint16_t address);
+	void m_refreshColors();
+	NesColor m_resolveColor(uint8_t entry);
+
+	RENDER_MODE					m_renderMode = RENDER_MODE::DOT;
+	std::vector<NesColor>		m_screenBuffer;
+	std::shared_ptr<IFrameSink> m_frameSink = nullptr;
+	std::shared_ptr<ITileSource> m_tileSource = nullptr;
+
+	// Sprites
+	struct Sprite {
+		uint64_t pixels = 0;	// Row on the line, flips applied
+		uint8_t x = 0;
+		uint8_t attribute = 0;
+		bool zero = false;		// OAM entry 0, for the hit flag
+	};
 
-	// SDL Rendering Stuff
-	SDL_Color*    m_screenBuffer;
-	SDL_Window*	  m_window;
-	SDL_Renderer* m_renderer;
+	uint8_t m_oam[256] = {};
+	uint8_t m_oamAddress = 0x00;
 
-	SDL_Color*	  m_patternBuffer;
-	SDL_Window*	  m_patternWindow;
-	SDL_Renderer* m_patternRenderer;
-	SDL_Texture*  m_patternScreen;
+	// Secondary OAM, the up to 8 sprites of the current line
+	Sprite m_sprites[8];
+	uint8_t m_spriteCount = 0;
 
-	SDL_Texture*  m_screen;
-	SDL_Event	  m_event;
-	uint8_t		  m_selectedPalette = 0x00;
+	// Dot the scanline path raises sprite 0's hit on, 0 for none this line
+	uint16_t m_spriteZeroDot = 0;
+
+	// Palette RAM resolved through m_palette, greyscale and emphasis
+	NesColor m_colors[0x20];
+	bool m_colorsDirty = true;
+	uint32_t m_colorsVersion = 0;
 	// -------------------
 
 
 	// TODO: Make this modular eventually so that we could
 	// swap out for a different pallette
-	SDL_Color m_palette[0x40] {
+	NesColor m_palette[0x40] {
 		{ 84,  84,  84, 255}, {  0,  30, 116, 255}, {  8,  16, 144, 255}, { 48,   0, 136, 255},
 		{ 68,   0, 100, 255}, { 92,   0,  48, 255}, { 84,   4,   0, 255}, { 60,  24,   0, 255},
 		{ 32,  42,   0, 255}, {  8,  58,   0, 255}, {  0,  64,   0, 255}, {  0,  60,   0, 255},
@@ -157,6 +209,28 @@ private:
 		uint8_t data;
 	}							PPU_STATUS;
 
-	// TODO: Add all other registers
+
+	// Internal VRAM Address	(v, t)
+	union LOOPY {
+		struct {
+			uint16_t coarseX		: 5;	//	Tile Column
+			uint16_t coarseY		: 5;	//	Tile Row
+			uint16_t nameTableX		: 1;	//	Nametable X
+			uint16_t nameTableY		: 1;	//	Nametable Y
+			uint16_t fineY			: 3;	//	Pixel Row in Tile
+			uint16_t unused			: 1;	//	Unused
+		};
+		uint16_t data = 0x0000;
+	};
+
+	LOOPY						vramAddress;	//	Current (v)
+	LOOPY						tramAddress;	//	Temporary (t)
+	uint8_t						fineX = 0x00;	//	Pixel Column in Tile (x)
+
+	uint64_t m_fetchTile(LOOPY address);
+	void m_incrementX(LOOPY& address);
+	void m_incrementY(LOOPY& address);
+	void m_copyX();
+	void m_copyY();
 
 };
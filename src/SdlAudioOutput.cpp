@@ -0,0 +1,52 @@
+#include "Config.h"
+
+#ifdef SDL_FRONTEND
+
+#include "fmt/printf.h"
+
+#include "SdlAudioOutput.h"
+
+
+SdlAudioOutput::SdlAudioOutput(std::shared_ptr<NesAudioRing> ring) : m_ring(ring) {
+	if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+		fmt::print("Couldn't initialize SDL audio!");
+		return;
+	}
+
+	// Blocks well under the ring's target, so it never waits on one
+	SDL_AudioSpec wanted = {};
+	wanted.freq = (int)ring->sampleRate();
+	wanted.format = AUDIO_S16SYS;
+	wanted.channels = 1;
+	wanted.samples = 512;
+	wanted.callback = m_callback;
+	wanted.userdata = ring.get();
+
+	SDL_AudioSpec obtained;
+	m_device = SDL_OpenAudioDevice(NULL, 0, &wanted, &obtained, 0);
+	if (m_device == 0) {
+		fmt::print("Couldn't open an audio device: {}\n", SDL_GetError());
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+		return;
+	}
+
+	SDL_PauseAudioDevice(m_device, 0);
+}
+
+
+SdlAudioOutput::~SdlAudioOutput() {
+	if (m_device == 0)
+		return;
+
+	SDL_CloseAudioDevice(m_device);
+	SDL_QuitSubSystem(SDL_INIT_AUDIO);
+}
+
+
+// On SDL's audio thread, the ring's consumer side needs no lock
+void SdlAudioOutput::m_callback(void* userdata, Uint8* stream, int length) {
+	NesAudioRing* ring = (NesAudioRing*)userdata;
+	ring->read((int16_t*)stream, (size_t)length / sizeof(int16_t));
+}
+
+#endif
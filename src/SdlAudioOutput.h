@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+
+#include "sdl/SDL.h"
+
+#include "NesAudioRing.h"
+
+
+// Plays a NesAudioRing on the default SDL audio device. SDL's audio thread
+// takes the samples straight out of the ring, the emulation thread fills
+// it by handing the ring to NesSystem::setAudioSink().
+class SdlAudioOutput final {
+public:
+	SdlAudioOutput(std::shared_ptr<NesAudioRing> ring);
+	~SdlAudioOutput();
+
+	SdlAudioOutput(const SdlAudioOutput&) = delete;
+	SdlAudioOutput& operator=(const SdlAudioOutput&) = delete;
+
+	bool isOpen() { return m_device != 0; }
+
+private:
+	static void m_callback(void* userdata, Uint8* stream, int length);
+
+private:
+	std::shared_ptr<NesAudioRing> m_ring;
+	SDL_AudioDeviceID m_device = 0;
+};
@@ -0,0 +1,124 @@
+#include "Config.h"
+
+#ifdef SDL_FRONTEND
+
+#include "fmt/printf.h"
+
+#include "SdlFrameSink.h"
+
+
+SdlFrameSink::SdlFrameSink(PPU_2C02* ppu) : m_ppu(ppu), m_patternView(ppu) {
+	// Reference counted by SDL, so several sinks can coexist
+	if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0) {
+		fmt::print("Couldn't initialize SDL video!");
+		return;
+	}
+
+	m_window = SDL_CreateWindow(
+		"POCNESEMU",
+		SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+		1024, 960, NULL
+	);
+
+	m_renderer = SDL_CreateRenderer(m_window, -1, 0);
+	m_screen = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA32,
+		SDL_TEXTUREACCESS_STREAMING, frameWidth, frameHeight);
+
+	m_patternWindow = SDL_CreateWindow(
+		"POCNESEMU - Pattern Tables",
+		SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+		512, 240, SDL_WINDOW_HIDDEN
+	);
+
+	m_patternRenderer = SDL_CreateRenderer(m_patternWindow, 0, 0);
+	m_patternScreen = SDL_CreateTexture(m_patternRenderer, SDL_PIXELFORMAT_RGBA32,
+		SDL_TEXTUREACCESS_STREAMING, NesPatternView::width, NesPatternView::height);
+
+	m_isOpen = true;
+}
+
+
+SdlFrameSink::~SdlFrameSink() {
+	if (m_screen != nullptr)
+		SDL_DestroyTexture(m_screen);
+	if (m_renderer != nullptr)
+		SDL_DestroyRenderer(m_renderer);
+	if (m_window != nullptr)
+		SDL_DestroyWindow(m_window);
+	if (m_patternScreen != nullptr)
+		SDL_DestroyTexture(m_patternScreen);
+	if (m_patternRenderer != nullptr)
+		SDL_DestroyRenderer(m_patternRenderer);
+	if (m_patternWindow != nullptr)
+		SDL_DestroyWindow(m_patternWindow);
+
+	SDL_QuitSubSystem(SDL_INIT_VIDEO);
+}
+
+
+void SdlFrameSink::frameComplete(const NesColor* frame) {
+	if (!m_isOpen)
+		return;
+
+	m_pollEvents();
+
+	// Render Frame
+	SDL_UpdateTexture(m_screen, NULL, frame, sizeof(NesColor) * frameWidth);
+	SDL_RenderCopy(m_renderer, m_screen, NULL, NULL);
+	SDL_RenderPresent(m_renderer);
+
+	if (m_patternShown)
+		m_drawPatternTables();
+}
+
+
+void SdlFrameSink::m_pollEvents() {
+	SDL_Event event;
+
+	while (SDL_PollEvent(&event)) {
+		if (event.type == SDL_WINDOWEVENT
+			&& event.window.event == SDL_WINDOWEVENT_CLOSE) {
+			if (SDL_GetWindowID(m_window) == event.window.windowID) {
+				m_isOpen = false;
+			}
+			if (SDL_GetWindowID(m_patternWindow) == event.window.windowID) {
+				SDL_HideWindow(m_patternWindow);
+				m_patternShown = false;
+			}
+		}
+		else if (event.type == SDL_WINDOWEVENT
+			&& event.window.event == SDL_WINDOWEVENT_EXPOSED
+			&& SDL_GetWindowID(m_patternWindow) == event.window.windowID) {
+			// Unchanged tables aren't redrawn, but the window still has to be
+			m_presentPatternTables();
+		}
+		else if (event.type == SDL_KEYDOWN) {
+			if (event.key.keysym.sym == SDLK_LEFTBRACKET)
+				--m_selectedPalette &= 0x07;
+			if (event.key.keysym.sym == SDLK_RIGHTBRACKET)
+				++m_selectedPalette &= 0x07;
+			if (event.key.keysym.sym == SDLK_p && m_ppu != nullptr) {
+				SDL_ShowWindow(m_patternWindow);
+				m_patternShown = true;
+			}
+		}
+	}
+}
+
+
+void SdlFrameSink::m_drawPatternTables() {
+	if (!m_patternView.update(m_selectedPalette))
+		return;
+
+	SDL_UpdateTexture(m_patternScreen, NULL, m_patternView.getImage(),
+		sizeof(NesColor) * NesPatternView::width);
+	m_presentPatternTables();
+}
+
+
+void SdlFrameSink::m_presentPatternTables() {
+	SDL_RenderCopy(m_patternRenderer, m_patternScreen, NULL, NULL);
+	SDL_RenderPresent(m_patternRenderer);
+}
+
+#endif
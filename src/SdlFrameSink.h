@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include "sdl/SDL.h"
+
+#include "IFrameSink.h"
+#include "NesPatternView.h"
+#include "PPU_2C02.h"
+
+
+// SDL window front end. Shows the frames, stops the system when the window
+// is closed and, given the PPU, has a pattern table window opened with P
+// whose palette [ and ] select. That one is only redrawn while it's open
+// and its contents changed.
+class SdlFrameSink final : public IFrameSink {
+public:
+	SdlFrameSink(PPU_2C02* ppu = nullptr);
+	~SdlFrameSink();
+
+	SdlFrameSink(const SdlFrameSink&) = delete;
+	SdlFrameSink& operator=(const SdlFrameSink&) = delete;
+
+	void frameComplete(const NesColor* frame) override;
+	bool isOpen() override { return m_isOpen; }
+
+private:
+	void m_pollEvents();
+	void m_drawPatternTables();
+	void m_presentPatternTables();
+
+private:
+	PPU_2C02* m_ppu;
+	bool m_isOpen = false;
+
+	SDL_Window*	  m_window	 = nullptr;
+	SDL_Renderer* m_renderer = nullptr;
+	SDL_Texture*  m_screen	 = nullptr;
+
+	NesPatternView m_patternView;
+	SDL_Window*	  m_patternWindow	= nullptr;
+	SDL_Renderer* m_patternRenderer = nullptr;
+	SDL_Texture*  m_patternScreen	= nullptr;
+	bool		  m_patternShown	= false;
+	uint8_t		  m_selectedPalette = 0x00;
+};
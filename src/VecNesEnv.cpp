@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <cstring>
+
+#include "fmt/printf.h"
+
+#include "VecNesEnv.h"
+
+
+VecNesEnv::Env::Env()
+	: ppu(std::make_shared<PPU_2C02>()),
+	ram(std::make_shared<NesArrayRam>(ramSize)),
+	nes(makeHeadlessCore(ppu, ram)) {
+
+	uint16_t mask;
+	bool writable;
+	ram->directMemory(0x0000, ramData, mask, writable);
+}
+
+
+VecNesEnv::VecNesEnv(const char* romFilePath, size_t nEnvs, size_t nThreads, size_t frameSkip)
+	: m_nEnvs(nEnvs), m_frameSkip(std::max<size_t>(frameSkip, 1)) {
+
+	m_image = NesCartridge::loadImage(romFilePath);
+	m_envs = std::make_unique<Env[]>(m_nEnvs);
+
+	for (size_t env = 0; env < m_nEnvs; env++) {
+		if (!m_envs[env].nes->loadCartridge(m_image))
+			return;
+
+		m_envs[env].nes->reset();
+	}
+
+	// Resets are loads of the first system's power up state
+	if (m_nEnvs > 0)
+		m_envs[0].nes->saveState(m_startState);
+
+	m_loaded = true;
+
+	if (nThreads == 0)
+		nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (size_t worker = 1; worker < std::min(nThreads, m_nEnvs); worker++)
+		m_workers.emplace_back(&VecNesEnv::m_work, this);
+}
+
+
+VecNesEnv::~VecNesEnv() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_wake.notify_all();
+	for (std::thread& worker : m_workers)
+		worker.join();
+}
+
+
+bool VecNesEnv::setObservation(OBSERVATION format, size_t downscale) {
+	if (downscale != 1 && downscale != 2 && downscale != 4 && downscale != 8) {
+		fmt::print("Observations can only be scaled down by 1, 2, 4 or 8!\n");
+		return false;
+	}
+
+	m_format = format;
+	m_downscale = downscale;
+
+	return true;
+}
+
+
+size_t VecNesEnv::observationSize() const {
+	size_t pixelSize = (m_format == OBSERVATION::RGBA) ? sizeof(NesColor) : 1;
+	return observationWidth() * observationHeight() * pixelSize;
+}
+
+
+void VecNesEnv::reset(const Batch& batch) {
+	if (m_loaded)
+		m_runAll(JOB::RESET, nullptr, batch);
+}
+
+
+void VecNesEnv::step(const uint8_t* buttons, const Batch& batch) {
+	if (m_loaded)
+		m_runAll(JOB::STEP, buttons, batch);
+}
+
+
+//	+-----------------------+
+//	|	   Thread Pool		|
+//	+-----------------------+
+
+// The caller's thread works through the systems too. The counters are
+// set last, they are what tells a worker still on the last job that
+// there's a new one.
+void VecNesEnv::m_runAll(JOB job, const uint8_t* buttons, const Batch& batch) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_job = job;
+		m_buttons = buttons;
+		m_batch = batch;
+
+		m_envsLeft.store(m_nEnvs);
+		m_nextEnv.store(0);
+		m_generation++;
+	}
+
+	m_wake.notify_all();
+	m_runEnvs();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_finished.wait(lock, [this]() { return m_envsLeft.load() == 0; });
+}
+
+
+void VecNesEnv::m_work() {
+	size_t generation = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [&]() { return m_stop || m_generation != generation; });
+
+			if (m_stop)
+				return;
+
+			generation = m_generation;
+		}
+
+		m_runEnvs();
+	}
+}
+
+
+void VecNesEnv::m_runEnvs() {
+	size_t env;
+
+	while ((env = m_nextEnv.fetch_add(1)) < m_nEnvs) {
+		if (m_job == JOB::RESET)
+			m_reset(m_envs[env]);
+		else
+			m_step(m_envs[env], m_buttons ? &m_buttons[env] : nullptr);
+
+		m_observe(env);
+
+		if (m_envsLeft.fetch_sub(1) == 1) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_finished.notify_one();
+		}
+	}
+}
+
+
+//	+-----------------------+
+//	|		 Systems		|
+//	+-----------------------+
+
+// The frame buffer isn't part of the state, clearing it keeps the
+// last episode's frame out of the next one's observations
+void VecNesEnv::m_reset(Env& slot) {
+	slot.nes->loadState(m_startState);
+	slot.ppu->clearFrameBuffer();
+	slot.frames = 0;
+	slot.done = false;
+}
+
+
+void VecNesEnv::m_step(Env& slot, const uint8_t* buttons) {
+	if (slot.done)
+		m_reset(slot);
+
+	if (buttons != nullptr)
+		slot.nes->setButtons(0, *buttons);
+
+	for (size_t frame = 0; frame < m_frameSkip && !slot.done; frame++) {
+		slot.nes->runFrame();
+		slot.frames++;
+
+		if (m_episodeFrames > 0 && slot.frames >= m_episodeFrames)
+			slot.done = true;
+	}
+}
+
+
+void VecNesEnv::m_observe(size_t env) {
+	const Env& slot = m_envs[env];
+
+	if (m_batch.observations != nullptr) {
+		uint8_t* out = m_batch.observations + env * m_batch.observationStride;
+
+		if (m_format == OBSERVATION::RGBA)
+			m_writeRgba(slot.ppu->getFrameBuffer(), out);
+		else
+			m_writeGrayscale(slot.ppu->getFrameBuffer(), out);
+	}
+
+	if (m_batch.ram != nullptr)
+		std::memcpy(m_batch.ram + env * m_batch.ramStride, slot.ramData, ramSize);
+
+	if (m_batch.dones != nullptr)
+		m_batch.dones[env] = slot.done ? 1 : 0;
+}
+
+
+//	+-----------------------+
+//	|		  Tests			|
+//	+-----------------------+
+
+// The lone system is set up like the pool's and steps through m_step too,
+// so this covers the threading and the shared ROM, not the emulation
+bool VecNesEnv::envTest(size_t nSteps) {
+	if (!m_loaded)
+		return false;
+
+	Env reference;
+	if (!reference.nes->loadCartridge(m_image))
+		return false;
+
+	reference.nes->reset();
+	m_reset(reference);
+
+	std::vector<uint8_t> observations(m_nEnvs * observationSize());
+	std::vector<uint8_t> ram(m_nEnvs * ramSize);
+	std::vector<uint8_t> dones(m_nEnvs);
+	std::vector<uint8_t> buttons(m_nEnvs);
+	std::vector<uint8_t> expected(observationSize());
+
+	Batch batch;
+	batch.observations = observations.data();
+	batch.observationStride = observationSize();
+	batch.ram = ram.data();
+	batch.dones = dones.data();
+
+	reset(batch);
+
+	uint32_t seed = 1;
+
+	for (size_t stepIndex = 0; stepIndex <= nSteps; stepIndex++) {
+		if (stepIndex > 0) {
+			seed = seed * 1103515245 + 12345;
+			std::fill(buttons.begin(), buttons.end(), (uint8_t)(seed >> 16));
+
+			step(buttons.data(), batch);
+			m_step(reference, &buttons[0]);
+		}
+
+		if (m_format == OBSERVATION::RGBA)
+			m_writeRgba(reference.ppu->getFrameBuffer(), expected.data());
+		else
+			m_writeGrayscale(reference.ppu->getFrameBuffer(), expected.data());
+
+		for (size_t env = 0; env < m_nEnvs; env++) {
+			bool matches = std::memcmp(&observations[env * observationSize()], expected.data(), observationSize()) == 0
+				&& std::memcmp(&ram[env * ramSize], reference.ramData, ramSize) == 0
+				&& dones[env] == (reference.done ? 1 : 0);
+
+			if (!matches) {
+				fmt::print("Env test failed: system {} differs at step {}\n", env, stepIndex);
+				return false;
+			}
+		}
+	}
+
+	fmt::print("Env test passed: {} systems match over {} steps\n", m_nEnvs, nSteps);
+	return true;
+}
+
+
+//	+-----------------------+
+//	|	   Observations		|
+//	+-----------------------+
+
+// Blocks of downscale x downscale pixels are averaged
+void VecNesEnv::m_writeRgba(const NesColor* frame, uint8_t* out) {
+	if (m_downscale == 1) {
+		std::memcpy(out, frame, IFrameSink::frameWidth * IFrameSink::frameHeight * sizeof(NesColor));
+		return;
+	}
+
+	const size_t area = m_downscale * m_downscale;
+
+	for (size_t y = 0; y < observationHeight(); y++) {
+		for (size_t x = 0; x < observationWidth(); x++) {
+			uint32_t r = 0, g = 0, b = 0;
+
+			for (size_t row = 0; row < m_downscale; row++) {
+				const NesColor* pixel = frame + (y * m_downscale + row) * IFrameSink::frameWidth + x * m_downscale;
+
+				for (size_t column = 0; column < m_downscale; column++) {
+					r += pixel[column].r;
+					g += pixel[column].g;
+					b += pixel[column].b;
+				}
+			}
+
+			*out++ = (uint8_t)(r / area);
+			*out++ = (uint8_t)(g / area);
+			*out++ = (uint8_t)(b / area);
+			*out++ = 255;
+		}
+	}
+}
+
+
+// BT.601 luma in 8 bit fixed point
+void VecNesEnv::m_writeGrayscale(const NesColor* frame, uint8_t* out) {
+	const size_t area = m_downscale * m_downscale;
+
+	for (size_t y = 0; y < observationHeight(); y++) {
+		for (size_t x = 0; x < observationWidth(); x++) {
+			uint32_t luma = 0;
+
+			for (size_t row = 0; row < m_downscale; row++) {
+				const NesColor* pixel = frame + (y * m_downscale + row) * IFrameSink::frameWidth + x * m_downscale;
+
+				for (size_t column = 0; column < m_downscale; column++)
+					luma += (77 * pixel[column].r + 150 * pixel[column].g + 29 * pixel[column].b) >> 8;
+			}
+
+			*out++ = (uint8_t)(luma / area);
+		}
+	}
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#include "NesCore.h"
+
+
+enum class OBSERVATION {
+	RGBA,		// NesColor pixels, as the PPU renders them
+	GRAYSCALE	// One byte of luma per pixel
+};
+
+
+// A batch of systems running the same ROM, stepped together for training
+// loops: a step takes a button byte per system and runs every system for
+// frameSkip frames on a pool of threads, writing observations, RAM and done
+// flags straight into the caller's buffers. Nothing is allocated per step.
+//
+// The systems share one copy of the ROM and of its decoded CHR ROM tiles.
+// Their slots sit in one array, each on its own cache lines (the systems
+// themselves are separate allocations). A system is done once it has run
+// episodeFrames frames (if set) or stopped, and goes back to the power up
+// state at the start of the step after that.
+class VecNesEnv final {
+public:
+	// 0 threads is one per hardware thread, the caller's thread is one of them
+	VecNesEnv(const char* romFilePath, size_t nEnvs, size_t nThreads = 0, size_t frameSkip = 1);
+	~VecNesEnv();
+
+	VecNesEnv(const VecNesEnv&) = delete;
+	VecNesEnv& operator=(const VecNesEnv&) = delete;
+
+	bool isLoaded() const { return m_loaded; }
+	size_t size() const { return m_nEnvs; }
+
+	// Scales observations down by 1, 2, 4 or 8 (averaging blocks of pixels)
+	bool setObservation(OBSERVATION format, size_t downscale = 1);
+	void setEpisodeFrames(size_t frames) { m_episodeFrames = frames; }
+
+	size_t observationWidth() const { return IFrameSink::frameWidth / m_downscale; }
+	size_t observationHeight() const { return IFrameSink::frameHeight / m_downscale; }
+	size_t observationSize() const;
+
+	static constexpr size_t ramSize = 0x0800;
+
+	// Buffers of a step, one entry per system at the given stride in bytes.
+	// Any of them may be null to skip it.
+	struct Batch {
+		uint8_t* observations = nullptr;
+		size_t observationStride = 0;
+		uint8_t* ram = nullptr;
+		size_t ramStride = ramSize;
+		uint8_t* dones = nullptr;
+	};
+
+	// Puts every system back to the power up state
+	void reset(const Batch& batch);
+
+	// buttons holds a byte per system (see NesSystem::setButtons)
+	void step(const uint8_t* buttons, const Batch& batch);
+
+	// Steps every system with the same buttons and checks that they all
+	// match a lone system run alongside, from a reset on
+	bool envTest(size_t nSteps = 600);
+
+private:
+	struct alignas(64) Env {
+		Env();
+
+		std::shared_ptr<PPU_2C02> ppu;
+		std::shared_ptr<NesArrayRam> ram;
+		std::unique_ptr<NesFastCore> nes;
+		uint8_t* ramData = nullptr;
+
+		size_t frames = 0;
+		bool done = false;
+	};
+
+	// Runs the job on every system, spread over the threads
+	enum class JOB { RESET, STEP };
+	void m_runAll(JOB job, const uint8_t* buttons, const Batch& batch);
+	void m_work();
+	void m_runEnvs();
+
+	void m_reset(Env& slot);
+	void m_step(Env& slot, const uint8_t* buttons);
+	void m_observe(size_t env);
+
+	void m_writeRgba(const NesColor* frame, uint8_t* out);
+	void m_writeGrayscale(const NesColor* frame, uint8_t* out);
+
+private:
+	bool m_loaded = false;
+	size_t m_nEnvs;
+	size_t m_frameSkip;
+	size_t m_episodeFrames = 0;
+
+	OBSERVATION m_format = OBSERVATION::RGBA;
+	size_t m_downscale = 1;
+
+	std::shared_ptr<const NesRomImage> m_image;
+	std::unique_ptr<Env[]> m_envs;
+	std::vector<uint8_t> m_startState;
+
+	// The step being run, read by the workers while it runs
+	JOB m_job = JOB::STEP;
+	const uint8_t* m_buttons = nullptr;
+	Batch m_batch;
+
+	// Systems are claimed one at a time, so slow ones don't hold up a thread's share
+	std::atomic<size_t> m_nextEnv{ 0 };
+	std::atomic<size_t> m_envsLeft{ 0 };
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_finished;
+	size_t m_generation = 0;
+	bool m_stop = false;
+};
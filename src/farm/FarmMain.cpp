@@ -0,0 +1,64 @@
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <chrono>
+
+#include "fmt/printf.h"
+
+#include "NesFarm.h"
+
+
+// Batch runner, "PocNesFarm <manifest> [-j <workers>]"
+int main(int argc, char** argv) {
+	const char* manifestPath = nullptr;
+	size_t nWorkers = 0;
+
+	for (int arg = 1; arg < argc; arg++) {
+		if (std::strcmp(argv[arg], "-j") == 0 && arg + 1 < argc)
+			nWorkers = (size_t)std::strtoul(argv[++arg], nullptr, 10);
+		else
+			manifestPath = argv[arg];
+	}
+
+	if (manifestPath == nullptr) {
+		fmt::print("Usage: {} <manifest> [-j <workers>]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<NesFarm::Job> jobs;
+	if (!NesFarm::loadManifest(manifestPath, jobs))
+		return 1;
+
+	NesFarm farm(nWorkers);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<NesFarm::Result> results = farm.run(jobs);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	fmt::print("\n{:>4} {:>6} {:>8} {:>8} {:>9} {:>16}  {}\n",
+		"job", "worker", "frames", "seconds", "fps", "last frame", "rom");
+
+	size_t totalFrames = 0;
+	size_t failed = 0;
+
+	for (size_t job = 0; job < jobs.size(); job++) {
+		const NesFarm::Result& result = results[job];
+
+		if (!result.loaded) {
+			fmt::print("{:>4} {:>6} {:>8}  {}\n", job, result.worker, "failed", jobs[job].romPath);
+			failed++;
+			continue;
+		}
+
+		double fps = (result.seconds > 0.0) ? result.frames / result.seconds : 0.0;
+		fmt::print("{:>4} {:>6} {:>8} {:>8.2f} {:>9.1f} {:016X}  {}\n", job, result.worker,
+			result.frames, result.seconds, fps, result.checksum, jobs[job].romPath);
+
+		totalFrames += result.frames;
+	}
+
+	fmt::print("\n{} jobs ({} failed) on {} workers: {} frames in {:.2f}s, {:.1f} fps\n",
+		jobs.size(), failed, farm.workers(), totalFrames, seconds, totalFrames / seconds);
+
+	return (failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <chrono>
+
+#include "fmt/printf.h"
+
+#include "NesFarm.h"
+#include "../NesCore.h"
+
+
+bool NesFarm::loadManifest(const char* filePath, std::vector<Job>& jobs) {
+	std::ifstream manifest(filePath);
+	if (!manifest.is_open()) {
+		fmt::print("Couldn't open job manifest {}!\n", filePath);
+		return false;
+	}
+
+	std::string line;
+	size_t lineNumber = 0;
+
+	while (std::getline(manifest, line)) {
+		lineNumber++;
+
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream fields(line);
+		Job job;
+
+		if (!(fields >> job.romPath))
+			continue;
+
+		if (!(fields >> job.frames) || job.frames == 0) {
+			fmt::print("Manifest line {}: expected \"<rom path> <frames> [<movie path>]\"!\n", lineNumber);
+			return false;
+		}
+
+		fields >> job.moviePath;
+
+		jobs.push_back(job);
+	}
+
+	return true;
+}
+
+
+NesFarm::NesFarm(size_t nWorkers) {
+	if (nWorkers == 0)
+		nWorkers = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (size_t worker = 0; worker < nWorkers; worker++)
+		m_queues.push_back(std::make_unique<Queue>());
+}
+
+
+std::vector<NesFarm::Result> NesFarm::run(const std::vector<Job>& jobs) {
+	std::vector<Result> results(jobs.size());
+
+	for (size_t job = 0; job < jobs.size(); job++)
+		m_queues[job % m_queues.size()]->jobs.push_back(job);
+
+	// Every result is only ever written by the worker that ran its job
+	std::vector<std::thread> threads;
+	for (size_t worker = 0; worker < m_queues.size(); worker++) {
+		threads.emplace_back([this, worker, &jobs, &results]() {
+			size_t job;
+			while (m_take(worker, job)) {
+				results[job] = m_runJob(jobs[job]);
+				results[job].worker = worker;
+			}
+		});
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	return results;
+}
+
+
+// Own jobs come off the front, stolen ones off the back of the
+// victim's queue, where its owner will get to last
+bool NesFarm::m_take(size_t worker, size_t& job) {
+	for (size_t offset = 0; offset < m_queues.size(); offset++) {
+		Queue& queue = *m_queues[(worker + offset) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (queue.jobs.empty())
+			continue;
+
+		if (offset == 0) {
+			job = queue.jobs.front();
+			queue.jobs.pop_front();
+		}
+		else {
+			job = queue.jobs.back();
+			queue.jobs.pop_back();
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+
+NesFarm::Result NesFarm::m_runJob(const Job& job) {
+	std::shared_ptr<PPU_2C02> ppu = std::make_shared<PPU_2C02>();
+	std::unique_ptr<NesFastCore> nes = makeHeadlessCore(ppu, std::make_shared<NesArrayRam>(0x0800));
+
+	Result result;
+	if (!nes->loadCartridge(job.romPath.c_str()))
+		return result;
+
+	nes->reset();
+
+	// The movie starts from its own state and is checked against the ROM
+	if (!job.moviePath.empty()) {
+		NesMovie movie;
+		if (!movie.load(job.moviePath.c_str()) || !nes->playMovie(movie))
+			return result;
+	}
+
+	result.loaded = true;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t frame = 0; frame < job.frames && ppu->isRunning(); frame++) {
+		nes->runFrame();
+		result.frames++;
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const uint8_t* pixels = (const uint8_t*)ppu->getFrameBuffer();
+	result.checksum = 0xCBF29CE484222325;
+	for (size_t byte = 0; byte < IFrameSink::frameWidth * IFrameSink::frameHeight * sizeof(NesColor); byte++)
+		result.checksum = (result.checksum ^ pixels[byte]) * 0x100000001B3;
+
+	return result;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <memory>
+
+
+// Runs a batch of independent jobs (a ROM for a number of frames, optionally
+// playing back a movie), one headless system per worker thread at a time.
+// Jobs are dealt out to the workers round robin, a worker takes from the
+// front of its own queue and, once it's empty, steals from the back of
+// another's, so a few long jobs don't leave the other threads idle.
+// Systems share nothing, each job builds its own.
+class NesFarm final {
+public:
+	struct Job {
+		std::string romPath;
+		size_t frames = 0;
+		std::string moviePath;	// Empty runs without input
+	};
+
+	struct Result {
+		bool loaded = false;	// ROM and movie, if any, loaded and match
+		size_t frames = 0;
+		double seconds = 0.0;
+		uint64_t checksum = 0;	// FNV-1a of the last frame, for regressions
+		size_t worker = 0;
+	};
+
+	// One job per line, "<rom path> <frames> [<movie path>]", # starts a comment
+	static bool loadManifest(const char* filePath, std::vector<Job>& jobs);
+
+	// 0 workers is one per hardware thread
+	NesFarm(size_t nWorkers = 0);
+
+	std::vector<Result> run(const std::vector<Job>& jobs);
+
+	size_t workers() const { return m_queues.size(); }
+
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<size_t> jobs;
+	};
+
+	bool m_take(size_t worker, size_t& job);
+	static Result m_runJob(const Job& job);
+
+private:
+	std::vector<std::unique_ptr<Queue>> m_queues;
+};